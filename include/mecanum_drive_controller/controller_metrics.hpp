@@ -0,0 +1,152 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__CONTROLLER_METRICS_HPP_
+#define MECANUM_DRIVE_CONTROLLER__CONTROLLER_METRICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "mecanum_drive_controller/fault_monitor.hpp"
+#include "mecanum_drive_controller/latency_histogram.hpp"
+#include "mecanum_drive_controller/load_shedder.hpp"
+
+namespace mecanum_drive_controller {
+/// Realtime publishers whose failed `trylock()` is counted
+enum class MetricsPublisher : std::size_t {
+  ODOMETRY = 0,
+  CONTROLLER_STATE,
+  CONTROLLER_STATE_STATISTICS,
+  FAULT_STATE,
+  MAP_POSE
+};
+static constexpr std::size_t NR_METRICS_PUBLISHERS = 5;
+
+/// Sources of the applied reference with a known age. Chained references
+/// carry no stamp, their age is not recorded.
+enum class ReferenceInput : std::size_t { TOPIC = 0 };
+static constexpr std::size_t NR_REFERENCE_INPUTS = 1;
+
+/// \brief Counters of the update loop.
+///
+/// The RT thread updates them with relaxed atomic increments, any other
+/// thread can read them at any time, e.g. to export them.
+class ControllerMetrics {
+public:
+  /// Upper bounds of the cycle duration histogram buckets [ns], a last
+  /// bucket counts the longer cycles
+  static constexpr LatencyHistogram::Bounds CYCLE_DURATION_BOUNDS = {
+      10000,  25000,   50000,   100000,  250000,
+      500000, 1000000, 2500000, 5000000, 10000000};
+  static constexpr std::size_t NR_CYCLE_DURATION_BUCKETS =
+      LatencyHistogram::NR_BUCKETS;
+
+  /// Upper bounds of the reference age histogram buckets [ns]
+  static constexpr LatencyHistogram::Bounds REFERENCE_AGE_BOUNDS = {
+      1000000,  2000000,   5000000,   10000000,  20000000,
+      50000000, 100000000, 200000000, 500000000, 1000000000};
+
+  /// Upper bounds of the reference pipeline duration histogram buckets [ns]
+  static constexpr LatencyHistogram::Bounds
+      REFERENCE_PIPELINE_DURATION_BOUNDS = {25,   50,   100,  250,   500,
+                                            1000, 2500, 5000, 10000, 25000};
+
+  ControllerMetrics();
+
+  /// \brief Sets all counters to zero, not thread-safe wrt. the RT thread
+  void reset();
+
+  void count_cycle() { increment(cycles_); }
+
+  void record_cycle_duration(const std::chrono::nanoseconds duration) {
+    cycle_durations_.record(duration);
+  }
+
+  /// \brief Records the age of a reference applied to the wheels, from its
+  /// stamp to the update time consuming it
+  void record_reference_age(const ReferenceInput input,
+                            const std::chrono::nanoseconds age) {
+    reference_ages_[static_cast<std::size_t>(input)].record(age);
+  }
+
+  /// \brief Records the duration of all configured reference pipeline
+  /// stages of a cycle
+  void
+  record_reference_pipeline_duration(const std::chrono::nanoseconds duration) {
+    reference_pipeline_durations_.record(duration);
+  }
+
+  void count_dropped_publish(const MetricsPublisher publisher) {
+    increment(dropped_publishes_[static_cast<std::size_t>(publisher)]);
+  }
+
+  /// \brief Counts a topic reference dropped after timing out, once per
+  /// message as it is consumed then
+  void count_reference_timeout() { increment(reference_timeouts_); }
+
+  void count_invalid_wheel_states() { increment(invalid_wheel_states_); }
+
+  std::uint64_t cycles() const { return load(cycles_); }
+  std::uint64_t cycle_duration_bucket(const std::size_t bucket) const {
+    return cycle_durations_.bucket(bucket);
+  }
+  const LatencyHistogram &cycle_durations() const { return cycle_durations_; }
+  const LatencyHistogram &reference_ages(const ReferenceInput input) const {
+    return reference_ages_[static_cast<std::size_t>(input)];
+  }
+  const LatencyHistogram &reference_pipeline_durations() const {
+    return reference_pipeline_durations_;
+  }
+  std::uint64_t dropped_publishes(const MetricsPublisher publisher) const {
+    return load(dropped_publishes_[static_cast<std::size_t>(publisher)]);
+  }
+  std::uint64_t reference_timeouts() const {
+    return load(reference_timeouts_);
+  }
+  std::uint64_t invalid_wheel_states() const {
+    return load(invalid_wheel_states_);
+  }
+
+  /// \brief Renders these metrics and the counters of the load shedder and
+  /// the fault monitor in the Prometheus text exposition format
+  /// \param controller Value of the `controller` label
+  std::string render_prometheus(const std::string &controller,
+                                const LoadShedder &load_shedder,
+                                const FaultMonitor &fault_monitor) const;
+
+private:
+  static void increment(std::atomic<std::uint64_t> &counter) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+  }
+  static std::uint64_t load(const std::atomic<std::uint64_t> &counter) {
+    return counter.load(std::memory_order_relaxed);
+  }
+
+  std::atomic<std::uint64_t> cycles_;
+  LatencyHistogram cycle_durations_;
+  std::array<LatencyHistogram, NR_REFERENCE_INPUTS> reference_ages_;
+  LatencyHistogram reference_pipeline_durations_;
+  std::array<std::atomic<std::uint64_t>, NR_METRICS_PUBLISHERS>
+      dropped_publishes_;
+  std::atomic<std::uint64_t> reference_timeouts_;
+  std::atomic<std::uint64_t> invalid_wheel_states_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__CONTROLLER_METRICS_HPP_
@@ -0,0 +1,36 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__CRC32_HPP_
+#define MECANUM_DRIVE_CONTROLLER__CRC32_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mecanum_drive_controller {
+/// \brief CRC-32 (IEEE 802.3), the same checksum as zlib's crc32
+inline std::uint32_t crc32(const std::uint8_t *data, const std::size_t size) {
+  std::uint32_t crc = 0xffffffffu;
+  for (std::size_t i = 0; i < size; ++i) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__CRC32_HPP_
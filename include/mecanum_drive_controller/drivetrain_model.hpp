@@ -0,0 +1,104 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__DRIVETRAIN_MODEL_HPP_
+#define MECANUM_DRIVE_CONTROLLER__DRIVETRAIN_MODEL_HPP_
+
+#include <array>
+#include <cstddef>
+
+#include "mecanum_drive_controller/kinematics.hpp"
+
+namespace mecanum_drive_controller {
+/// \brief Parameters of the simulated drivetrain, a value of 0 disables the
+/// respective effect
+struct DrivetrainModelParams {
+  /// Time constant of the first-order motor response [s]
+  double time_constant = 0.0;
+  /// Magnitude the wheel velocity is saturated at [rad/s]
+  double max_velocity = 0.0;
+  /// Encoder ticks per wheel revolution
+  double encoder_resolution = 0.0;
+  /// Delay between a command and the start of the motor response [s]
+  double command_delay = 0.0;
+  /// Fraction of each wheel's rim velocity lost by roller slip, in [0, 1)
+  WheelVelocities slip_ratio{};
+  /// Geometry used to move the simulated ground-truth pose
+  MecanumKinematicsParams kinematics;
+};
+
+/// \brief Simulates four velocity-controlled wheel motors and the resulting
+/// motion of a mecanum base.
+///
+/// Wheel order is front left, front right, rear right, rear left. Commands
+/// pass a delay line and a saturation and drive a first-order response. The
+/// encoder positions are quantized to the resolution and the reported
+/// velocities are their differences, as on real drives. Roller slip reduces
+/// the wheels' contribution to the ground-truth motion of the base, which is
+/// not visible to the encoders. Allocation free, suitable for a `read()` /
+/// `write()` cycle.
+class DrivetrainModel {
+public:
+  /// Capacity of the command delay line, a longer delay than this many
+  /// cycles is shortened
+  static constexpr std::size_t MAX_DELAYED_COMMANDS = 1024;
+
+  DrivetrainModel();
+
+  /// \brief Sets the parameters and resets the state
+  void configure(const DrivetrainModelParams &params);
+
+  /// \brief Stops the wheels and moves the base to the origin
+  void reset();
+
+  /// \brief Queues wheel velocity commands [rad/s] at the current time
+  void set_commands(const WheelVelocities &commands);
+
+  /// \brief Advances the simulation by `dt` [s]
+  void step(const double dt);
+
+  /// \return quantized encoder positions [rad]
+  const WheelVelocities &positions() const { return encoder_positions_; }
+  /// \return encoder velocities over the last step [rad/s]
+  const WheelVelocities &velocities() const { return encoder_velocities_; }
+  /// \return unquantized wheel velocities [rad/s]
+  const WheelVelocities &true_velocities() const { return velocities_; }
+  /// \return ground-truth pose of the base frame
+  const Pose2D &pose() const { return pose_; }
+  /// \return simulated time [s]
+  double time() const { return time_; }
+
+private:
+  struct DelayedCommand {
+    double time;
+    WheelVelocities commands;
+  };
+
+  DrivetrainModelParams params_;
+  double time_;
+  // ring buffer of commands, oldest at `delay_head_`
+  std::array<DelayedCommand, MAX_DELAYED_COMMANDS> delayed_commands_;
+  std::size_t delay_head_;
+  std::size_t delay_size_;
+  WheelVelocities active_commands_;
+  WheelVelocities positions_;
+  WheelVelocities velocities_;
+  WheelVelocities encoder_positions_;
+  WheelVelocities encoder_velocities_;
+  Pose2D pose_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__DRIVETRAIN_MODEL_HPP_
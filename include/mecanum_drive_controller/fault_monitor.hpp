@@ -0,0 +1,121 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__FAULT_MONITOR_HPP_
+#define MECANUM_DRIVE_CONTROLLER__FAULT_MONITOR_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "mecanum_drive_controller/kinematics.hpp"
+
+namespace mecanum_drive_controller {
+/// Internal operating mode of the controller
+enum class ControllerMode : std::uint8_t {
+  /// All checks pass
+  RUNNING = 0,
+  /// Commands are executed, but the reference is stale or cycles are late
+  DEGRADED = 1,
+  /// Wheels are commanded to zero until the fault is cleared
+  FAULT = 2,
+  /// Single cycle after a fault in which the internal state is reset
+  RECOVERING = 3
+};
+
+/// \brief Results of the checks of one cycle
+struct FaultConditions {
+  bool wheel_states_invalid = false; // fault
+  bool wheel_stalled = false;        // fault
+  bool reference_stale = false;      // degraded
+  bool cycle_late = false;           // degraded
+};
+
+/// \brief RT-safe state machine deciding the controller mode from the
+/// watchdog, stall and staleness checks.
+///
+/// FAULT is left either automatically after `recovery_cycles` fault-free
+/// cycles or on `request_reset()`, always through one RECOVERING cycle.
+class FaultMonitor {
+public:
+  FaultMonitor();
+
+  /// \param auto_recovery Leave FAULT without `request_reset()`
+  /// \param recovery_cycles Fault-free cycles before an automatic recovery
+  /// \param stall_command_threshold Wheel command above which a wheel has to
+  /// move [rad/s], zero disables the stall check
+  /// \param stall_velocity_threshold Wheel velocity below which a commanded
+  /// wheel counts as not moving [rad/s]
+  /// \param stall_cycles Consecutive stalled cycles before a fault
+  void configure(const bool auto_recovery, const std::size_t recovery_cycles,
+                 const double stall_command_threshold,
+                 const double stall_velocity_threshold,
+                 const std::size_t stall_cycles);
+
+  /// \brief Goes back to RUNNING and clears the checks, counters are kept
+  void reset();
+
+  /// \brief Stall check for one wheel, call for every wheel once per cycle
+  /// \param wheel Index of the wheel
+  /// \param command Last command written to the wheel [rad/s]
+  /// \param state Measured velocity of the wheel [rad/s]
+  /// \return true if the wheel is stalled
+  bool check_stall(const std::size_t wheel, const double command,
+                   const double state);
+
+  /// \brief Advances the state machine by one cycle
+  /// \return the mode for this cycle
+  ControllerMode update(const FaultConditions &conditions);
+
+  /// \brief Requests leaving FAULT, can be called from any thread
+  void request_reset() { reset_requested_.store(true); }
+
+  /// \return current mode, can be called from any thread
+  ControllerMode mode() const { return mode_.load(std::memory_order_relaxed); }
+
+  /// \return number of transitions into FAULT
+  std::uint64_t fault_count() const {
+    return fault_count_.load(std::memory_order_relaxed);
+  }
+
+  /// \return number of detected wheel stalls
+  std::uint64_t stall_count() const {
+    return stall_count_.load(std::memory_order_relaxed);
+  }
+
+  /// \return human readable name of `mode`
+  static const char *to_string(const ControllerMode mode);
+
+private:
+  static constexpr std::size_t MAX_WHEELS = NR_COUPLED_WHEELS;
+
+  bool auto_recovery_;
+  std::size_t recovery_cycles_;
+  double stall_command_threshold_;
+  double stall_velocity_threshold_;
+  std::size_t stall_cycles_;
+
+  std::array<std::size_t, MAX_WHEELS> stalled_cycles_;
+  std::size_t fault_free_cycles_;
+
+  std::atomic<ControllerMode> mode_;
+  std::atomic<bool> reset_requested_;
+  std::atomic<std::uint64_t> fault_count_;
+  std::atomic<std::uint64_t> stall_count_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__FAULT_MONITOR_HPP_
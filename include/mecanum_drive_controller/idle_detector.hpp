@@ -0,0 +1,90 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MECANUM_DRIVE_CONTROLLER__IDLE_DETECTOR_HPP_
+#define MECANUM_DRIVE_CONTROLLER__IDLE_DETECTOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace mecanum_drive_controller {
+/// \brief Detects a parked base to throttle the work of the update cycle.
+///
+/// The base goes idle after `idle_cycles` consecutive cycles without a
+/// nonzero reference and with all wheels at standstill. It wakes up in the
+/// first cycle with a nonzero reference or a moving wheel. While idle, the
+/// periodic outputs are only due every heartbeat period.
+///
+/// All methods are RT-safe. Counters can be read from any thread.
+class IdleDetector {
+public:
+  IdleDetector();
+
+  /// \brief Sets the detection policy and wakes up
+  /// \param idle_cycles Consecutive inactive cycles before going idle, zero
+  /// disables idling
+  /// \param velocity_threshold Wheel velocities up to this are standstill
+  /// [rad/s]
+  /// \param heartbeat_period Period of the outputs while idle
+  void configure(const std::size_t idle_cycles,
+                 const double velocity_threshold,
+                 const std::chrono::nanoseconds &heartbeat_period);
+
+  /// \brief Wakes up, counters are kept
+  void reset();
+
+  /// \return true if idling is configured
+  bool enabled() const { return idle_cycles_ > 0; }
+
+  /// \brief Feeds the inputs of this cycle
+  /// \param reference_active true if a nonzero reference is applied
+  /// \param wheel_velocities Wheel velocities [rad/s], NaN counts as motion
+  /// \param nr_wheels Number of `wheel_velocities`
+  /// \param period Time since the previous cycle
+  /// \return true if the base is idle in this cycle
+  bool update(const bool reference_active, const double *wheel_velocities,
+              const std::size_t nr_wheels,
+              const std::chrono::nanoseconds &period);
+
+  /// \return true if the base is idle
+  bool idle() const { return idle_; }
+
+  /// \return true if the periodic outputs are due in this cycle: always
+  /// while awake, once per heartbeat period while idle
+  bool should_publish() const { return !idle_ || heartbeat_; }
+
+  /// \return number of cycles spent idle
+  std::uint64_t idle_cycle_count() const {
+    return idle_cycle_count_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::size_t idle_cycles_;
+  double velocity_threshold_;
+  std::chrono::nanoseconds heartbeat_period_;
+
+  std::size_t inactive_cycles_;
+  bool idle_;
+  bool heartbeat_;
+  std::chrono::nanoseconds since_heartbeat_;
+
+  std::atomic<std::uint64_t> idle_cycle_count_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__IDLE_DETECTOR_HPP_
@@ -0,0 +1,153 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__KINEMATICS_HPP_
+#define MECANUM_DRIVE_CONTROLLER__KINEMATICS_HPP_
+
+#include <array>
+#include <cstddef>
+
+namespace mecanum_drive_controller {
+/// Number of wheels, sorted front left, front right, rear right, rear left
+constexpr std::size_t NR_WHEELS = 4;
+
+using WheelVelocities = std::array<double, NR_WHEELS>;
+
+/// \brief Geometry of the mecanum base
+struct MecanumKinematicsParams {
+  double wheels_radius = 0.0; // [m]
+  /// lx + ly, the distances from the robot's center to the wheels projected
+  /// on the x and y axis [m]
+  double sum_of_robot_center_projection_on_X_Y_axis = 0.0;
+  /// Base frame wrt the center frame [x, y, theta]
+  std::array<double, 3> base_frame_offset{};
+};
+
+/// \brief Planar twist [m/s, m/s, rad/s]
+struct BodyTwist {
+  double linear_x = 0.0;
+  double linear_y = 0.0;
+  double angular_z = 0.0;
+};
+
+/// \brief Planar pose [m, m, rad]
+struct Pose2D {
+  double x = 0.0;
+  double y = 0.0;
+  double rz = 0.0;
+};
+
+/// \brief Computes the wheel velocities realizing a body twist of the base
+/// frame
+/// \return wheel velocities [rad/s]
+WheelVelocities inverse_kinematics(const MecanumKinematicsParams &params,
+                                   const BodyTwist &twist);
+
+/// \brief Converts a twist about a point into the body twist of the base
+/// frame, e.g. to rotate about a tool point
+/// \param twist Linear velocity of the point and angular velocity
+/// \param x Position of the point in the base frame [m]
+/// \param y Position of the point in the base frame [m]
+BodyTwist twist_about_point(const BodyTwist &twist, const double x,
+                            const double y);
+
+/// \brief Computes the body twist of the base frame out of the wheel
+/// velocities. The velocity is returned raw, without filtering.
+/// \param wheel_velocities Wheel velocities [rad/s]
+BodyTwist forward_kinematics(const MecanumKinematicsParams &params,
+                             const WheelVelocities &wheel_velocities);
+
+/// \brief Composes two poses (SE(2) product)
+/// \param a Pose of frame A in the reference frame
+/// \param b Pose of frame B in frame A
+/// \return pose of frame B in the reference frame
+Pose2D compose_poses(const Pose2D &a, const Pose2D &b);
+
+/// \brief Integrates a body twist into a pose expressed in the odometry frame
+/// (first order: the heading is integrated after the position)
+void integrate_pose(Pose2D &pose, const BodyTwist &twist, const double dt);
+
+/// \brief `inverse_kinematics()` of `count` twists
+/// \param twists Row-major `count` x 3 array [linear_x, linear_y, angular_z]
+/// \param wheel_velocities Row-major `count` x 4 output array
+void inverse_kinematics_batch(const MecanumKinematicsParams &params,
+                              const double *twists, const std::size_t count,
+                              double *wheel_velocities);
+
+/// \brief `forward_kinematics()` of `count` wheel velocity samples
+/// \param wheel_velocities Row-major `count` x 4 array
+/// \param twists Row-major `count` x 3 output array
+void forward_kinematics_batch(const MecanumKinematicsParams &params,
+                              const double *wheel_velocities,
+                              const std::size_t count, double *twists);
+
+/// Number of bases of a coupled carrier and of the wheels they drive, sorted
+/// base by base
+constexpr std::size_t NR_COUPLED_BASES = 2;
+constexpr std::size_t NR_COUPLED_WHEELS = NR_COUPLED_BASES * NR_WHEELS;
+
+using CoupledWheelVelocities = std::array<double, NR_COUPLED_WHEELS>;
+
+/// \brief Kinematics of mecanum bases rigidly coupled into one carrier and
+/// driven by a single body twist of the carrier frame.
+///
+/// The wheel velocities are linear in the twist, `w = J * twist`. The
+/// stacked Jacobian `J` and its least-squares pseudo-inverse are computed
+/// once in `configure()`, so that both directions are a fixed-size matrix
+/// product in the control loop.
+class CoupledKinematics {
+public:
+  /// \param params Geometry of each base, the base frame offset is wrt its
+  /// own center frame as for a single base
+  /// \param base_poses Pose of the base frame of each base in the carrier
+  /// frame
+  /// \return false if the wheels do not observe the full twist
+  bool configure(
+      const std::array<MecanumKinematicsParams, NR_COUPLED_BASES> &params,
+      const std::array<Pose2D, NR_COUPLED_BASES> &base_poses);
+
+  /// \brief Computes the wheel velocities of all bases realizing a body twist
+  /// of the carrier frame
+  /// \return wheel velocities [rad/s]
+  CoupledWheelVelocities inverse(const BodyTwist &twist) const;
+
+  /// \brief Computes the body twist of the carrier frame that best fits the
+  /// velocities of all wheels in the least-squares sense
+  /// \param wheel_velocities Wheel velocities [rad/s]
+  BodyTwist forward(const CoupledWheelVelocities &wheel_velocities) const;
+
+private:
+  /// Wheel velocities caused by a unit twist component, by wheel
+  std::array<std::array<double, 3>, NR_COUPLED_WHEELS> jacobian_{};
+  /// (J^T J)^-1 J^T, by twist component
+  std::array<std::array<double, NR_COUPLED_WHEELS>, 3> pseudo_inverse_{};
+};
+
+/// \brief Steps the odometry through `count` samples, as `Odometry::update()`
+/// does in the control loop. NaN samples are skipped like in the controller.
+/// \param pose Initial pose, the final pose on return
+/// \param wheel_velocities Row-major `count` x 4 array
+/// \param dts Time step of each sample [s]
+/// \param poses Row-major `count` x 3 output array of the pose after each
+/// sample, may be null
+/// \param twists Row-major `count` x 3 output array of the body twist of
+/// each sample, may be null
+void integrate_odometry_batch(const MecanumKinematicsParams &params,
+                              Pose2D &pose, const double *wheel_velocities,
+                              const double *dts, const std::size_t count,
+                              double *poses, double *twists);
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__KINEMATICS_HPP_
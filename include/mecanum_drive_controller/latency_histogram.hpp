@@ -0,0 +1,88 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__LATENCY_HISTOGRAM_HPP_
+#define MECANUM_DRIVE_CONTROLLER__LATENCY_HISTOGRAM_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace mecanum_drive_controller {
+/// \brief Histogram of durations over fixed buckets.
+///
+/// Recorded from the RT thread with relaxed atomic increments, readable from
+/// any other thread. The counts are not a consistent snapshot while
+/// recording, which is fine for monitoring.
+class LatencyHistogram {
+public:
+  static constexpr std::size_t NR_BOUNDS = 10;
+  /// Buckets up to each bound and a last one for longer durations
+  static constexpr std::size_t NR_BUCKETS = NR_BOUNDS + 1;
+  using Bounds = std::array<std::int64_t, NR_BOUNDS>;
+
+  /// \param bounds Ascending inclusive upper bounds of the buckets [ns]
+  explicit LatencyHistogram(const Bounds &bounds) : bounds_(bounds) {
+    reset();
+  }
+
+  /// \brief Sets all counts to zero, not thread-safe wrt. recording
+  void reset() {
+    for (auto &bucket : buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    sum_nanoseconds_.store(0, std::memory_order_relaxed);
+  }
+
+  void record(const std::chrono::nanoseconds duration) {
+    const auto bucket = static_cast<std::size_t>(
+        std::lower_bound(bounds_.begin(), bounds_.end(), duration.count()) -
+        bounds_.begin());
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    sum_nanoseconds_.fetch_add(
+        static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0)),
+        std::memory_order_relaxed);
+  }
+
+  const Bounds &bounds() const { return bounds_; }
+
+  std::uint64_t bucket(const std::size_t i) const {
+    return buckets_[i].load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t count() const {
+    std::uint64_t count = 0;
+    for (const auto &bucket : buckets_) {
+      count += bucket.load(std::memory_order_relaxed);
+    }
+    return count;
+  }
+
+  /// \return sum of the recorded durations, negative ones counted as 0 [ns]
+  std::uint64_t sum_nanoseconds() const {
+    return sum_nanoseconds_.load(std::memory_order_relaxed);
+  }
+
+private:
+  Bounds bounds_;
+  std::array<std::atomic<std::uint64_t>, NR_BUCKETS> buckets_;
+  std::atomic<std::uint64_t> sum_nanoseconds_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__LATENCY_HISTOGRAM_HPP_
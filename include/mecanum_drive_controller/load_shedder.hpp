@@ -0,0 +1,110 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__LOAD_SHEDDER_HPP_
+#define MECANUM_DRIVE_CONTROLLER__LOAD_SHEDDER_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace mecanum_drive_controller {
+/// Optional stages of the update cycle, sorted in the order they are dropped.
+/// Inverse kinematics and command writes are never shed.
+enum class ShedStage : std::size_t {
+  /// fault_state, map_pose and controller_state_statistics publishing
+  INTROSPECTION = 0,
+  TELEMETRY = 1,
+  CONTROLLER_STATE = 2,
+  ODOMETRY_DECIMATION = 3
+};
+
+static constexpr std::size_t NR_SHED_STAGES = 4;
+
+/// \brief Drops optional stages of the update cycle when recent cycles
+/// overrun their budget and restores them once the load goes away.
+///
+/// All methods are RT-safe. Counters can be read from any thread.
+class LoadShedder {
+public:
+  LoadShedder();
+
+  /// \brief Sets the shedding policy and resets the state
+  /// \param cycle_budget Budget of a cycle, zero disables shedding
+  /// \param overrun_cycles Consecutive overruns before one more stage is shed
+  /// \param recovery_cycles Consecutive in-budget cycles before one stage is
+  /// restored
+  /// \param odometry_decimation Odometry is published every N-th cycle while
+  /// decimation is active
+  void configure(const std::chrono::nanoseconds &cycle_budget,
+                 const std::size_t overrun_cycles,
+                 const std::size_t recovery_cycles,
+                 const std::size_t odometry_decimation);
+
+  /// \brief Restores all stages, counters are kept
+  void reset();
+
+  /// \return true if a cycle budget is configured
+  bool enabled() const { return cycle_budget_.count() > 0; }
+
+  /// \brief Feeds the duration of the finished cycle
+  void update(const std::chrono::nanoseconds &cycle_duration);
+
+  /// \return true if `stage` has to run in this cycle, counts it otherwise
+  bool should_run(const ShedStage stage);
+
+  /// \return true if odometry has to be published in this cycle
+  bool should_publish_odometry();
+
+  /// \return number of currently shed stages
+  std::size_t level() const { return level_.load(std::memory_order_relaxed); }
+
+  /// \return number of cycles `stage` was skipped
+  std::uint64_t shed_count(const ShedStage stage) const {
+    return shed_counts_[static_cast<std::size_t>(stage)].load(
+        std::memory_order_relaxed);
+  }
+
+  /// \return number of cycles that overran the budget
+  std::uint64_t overrun_count() const {
+    return overrun_count_.load(std::memory_order_relaxed);
+  }
+
+private:
+  bool is_shed(const ShedStage stage) const {
+    return level_.load(std::memory_order_relaxed) >
+           static_cast<std::size_t>(stage);
+  }
+
+  void count_shed(const ShedStage stage);
+
+  std::chrono::nanoseconds cycle_budget_;
+  std::size_t overrun_cycles_;
+  std::size_t recovery_cycles_;
+  std::size_t odometry_decimation_;
+
+  std::size_t consecutive_overruns_;
+  std::size_t consecutive_in_budget_;
+  std::size_t odometry_cycle_;
+
+  std::atomic<std::size_t> level_;
+  std::atomic<std::uint64_t> overrun_count_;
+  std::array<std::atomic<std::uint64_t>, NR_SHED_STAGES> shed_counts_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__LOAD_SHEDDER_HPP_
@@ -3,12 +3,32 @@
 
 #include "control_msgs/msg/mecanum_drive_controller_state.hpp"
 #include "controller_interface/chainable_controller_interface.hpp"
+#include "mecanum_drive_controller/controller_metrics.hpp"
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "geometry_msgs/msg/transform_stamped.hpp"
 #include "geometry_msgs/msg/twist_stamped.hpp"
+#include "mecanum_drive_controller/fault_monitor.hpp"
+#include "mecanum_drive_controller/idle_detector.hpp"
+#include "mecanum_drive_controller/kinematics.hpp"
+#include "mecanum_drive_controller/load_shedder.hpp"
+#include "mecanum_drive_controller/metrics_exporter.hpp"
+#include "mecanum_drive_controller/obstacle_speed_limit.hpp"
 #include "mecanum_drive_controller/odometry.hpp"
+#include "mecanum_drive_controller/reference_pipeline.hpp"
+#include "mecanum_drive_controller/reference_socket_listener.hpp"
+#include "mecanum_drive_controller/seqlock.hpp"
+#include "mecanum_drive_controller/shared_realtime_publisher.hpp"
+#include "mecanum_drive_controller/telemetry_recorder.hpp"
 #include "mecanum_drive_controller/visibility_control.h"
+#include "mecanum_drive_controller/wheel_velocity_estimator.hpp"
+#include "mecanum_drive_controller/yaw_rate_controller.hpp"
+#include "mecanum_drive_controller/window_statistics.hpp"
 #include "nav_msgs/msg/odometry.hpp"
 #include "realtime_tools/realtime_buffer.h"
-#include "realtime_tools/realtime_publisher.h"
+#include "std_msgs/msg/float64_multi_array.hpp"
+#include "std_msgs/msg/u_int64_multi_array.hpp"
+#include "std_msgs/msg/u_int8.hpp"
+#include "std_srvs/srv/trigger.hpp"
 #include "tf2_msgs/msg/tf_message.hpp"
 
 // auto-generated by generate_parameter_library
@@ -24,6 +44,32 @@ static constexpr size_t NR_CMD_ITFS = 4;
 // name constants for reference interfaces
 static constexpr size_t NR_REF_ITFS = 3;
 
+// reference interfaces following the twist: center of rotation in the base
+// frame, NaN rotates about the base frame
+static constexpr size_t NR_ROTATION_CENTER_ITFS = 2;
+static constexpr size_t ROTATION_CENTER_X = NR_REF_ITFS;
+static constexpr size_t ROTATION_CENTER_Y = NR_REF_ITFS + 1;
+
+// reference interfaces taking a map->odom correction [m, m, rad], applied if
+// all three are set
+static constexpr size_t NR_MAP_CORRECTION_ITFS = 3;
+static constexpr size_t MAP_CORRECTION_X =
+    NR_REF_ITFS + NR_ROTATION_CENTER_ITFS;
+static constexpr size_t MAP_CORRECTION_Y = MAP_CORRECTION_X + 1;
+static constexpr size_t MAP_CORRECTION_RZ = MAP_CORRECTION_X + 2;
+
+// signals of `~/controller_state_statistics`: wheel states, wheel commands and
+// reference, in this order
+static constexpr size_t NR_STATE_STATISTICS_SIGNALS =
+    NR_STATE_ITFS + NR_CMD_ITFS + NR_REF_ITFS;
+
+/// \brief Latest map->odom transform from localization
+struct MapCorrection {
+  /// Stamp of the correction, 0 if none was received [ns]
+  std::int64_t stamp_nanoseconds = 0;
+  Pose2D map_to_odom;
+};
+
 class MecanumDriveController
     : public controller_interface::ChainableControllerInterface {
 public:
@@ -67,6 +113,12 @@ public:
   using OdomStateMsg = nav_msgs::msg::Odometry;
   using TfStateMsg = tf2_msgs::msg::TFMessage;
   using ControllerStateMsg = control_msgs::msg::MecanumDriveControllerState;
+  using ObstacleDistancesMsg = std_msgs::msg::Float64MultiArray;
+  using FaultStateMsg = std_msgs::msg::UInt8;
+  using ControllerStateStatisticsMsg = std_msgs::msg::Float64MultiArray;
+  using ReferenceAgeHistogramMsg = std_msgs::msg::UInt64MultiArray;
+  using MapCorrectionMsg = geometry_msgs::msg::TransformStamped;
+  using MapPoseMsg = geometry_msgs::msg::PoseStamped;
 
 protected:
   std::shared_ptr<ParamListener> param_listener_;
@@ -88,9 +140,11 @@ protected:
 
   /// Internal lists with joint names.
   /**
-   * Internal lists with joint names sorted as in `WheelIndex` enum.
+   * Internal lists with joint names sorted as in `WheelIndex` enum. In
+   * coupled mode the wheels of the second base follow in the same order.
+   * Only the first `nr_joint_names_` entries are set.
    */
-  std::vector<std::string> command_joint_names_;
+  std::array<std::string, NR_COUPLED_WHEELS> command_joint_names_;
 
   /// Internal lists with joint names.
   /**
@@ -98,29 +152,85 @@ protected:
    * If parameters for state joint names are *not* defined, this list is the
    * same as `command_joint_names_`.
    */
-  std::vector<std::string> state_joint_names_;
+  std::array<std::string, NR_COUPLED_WHEELS> state_joint_names_;
 
-  // Names of the references, ex: high level vel commands from MoveIt, Nav2,
-  // etc.
-  // used for preceding controller
-  std::vector<std::string> reference_names_;
+  // number of set joint names, `NR_COUPLED_WHEELS` in coupled mode
+  size_t nr_joint_names_ = 0;
 
   // Command subscribers and Controller State, odom state, tf state publishers
   rclcpp::Subscription<ControllerReferenceMsg>::SharedPtr ref_subscriber_ =
       nullptr;
   realtime_tools::RealtimeBuffer<std::shared_ptr<ControllerReferenceMsg>>
       input_ref_;
-  rclcpp::Duration ref_timeout_ = rclcpp::Duration::from_seconds(0.0);
+  // `reference_timeout` [ns], precomputed for the RT loop
+  std::int64_t ref_timeout_nanoseconds_ = 0;
+
+  // obstacle distances for braking-distance speed limiting
+  rclcpp::Subscription<ObstacleDistancesMsg>::SharedPtr
+      obstacle_distances_subscriber_ = nullptr;
+  SeqLock<ObstacleDistances> obstacle_distances_;
+  ObstacleDistances last_obstacle_distances_;
+  // `obstacle_speed_limit.timeout` [ns], precomputed for the RT loop
+  std::int64_t obstacle_timeout_nanoseconds_ = 0;
+
+  // map->odom correction, the newest one of the topic and the reference
+  // interfaces is composed with the odometry into `~/map_pose`
+  rclcpp::Subscription<MapCorrectionMsg>::SharedPtr
+      map_correction_subscriber_ = nullptr;
+  SeqLock<MapCorrection> map_correction_;
+  MapCorrection last_map_correction_;
+  using MapPosePublisher =
+      SharedRealtimePublisher<MapPoseMsg, rclcpp::Publisher<MapPoseMsg>>;
+  rclcpp::Publisher<MapPoseMsg>::SharedPtr map_pose_s_publisher_;
+  std::unique_ptr<MapPosePublisher> map_pose_publisher_;
+  // every `map_pose.decimation`-th cycle is published
+  size_t map_pose_cycle_ = 0;
 
-  using OdomStatePublisher = realtime_tools::RealtimePublisher<OdomStateMsg>;
+  // the realtime publishers of all instances share one publishing thread
+  using OdomStatePublisher =
+      SharedRealtimePublisher<OdomStateMsg, rclcpp::Publisher<OdomStateMsg>>;
   rclcpp::Publisher<OdomStateMsg>::SharedPtr odom_s_publisher_;
   std::unique_ptr<OdomStatePublisher> rt_odom_state_publisher_;
 
   // controller state publisher
   using ControllerStatePublisher =
-      realtime_tools::RealtimePublisher<ControllerStateMsg>;
+      SharedRealtimePublisher<ControllerStateMsg,
+                              rclcpp::Publisher<ControllerStateMsg>>;
   rclcpp::Publisher<ControllerStateMsg>::SharedPtr controller_s_publisher_;
   std::unique_ptr<ControllerStatePublisher> controller_state_publisher_;
+  // every `controller_state_decimation`-th cycle is published
+  size_t controller_state_cycle_ = 0;
+
+  // min, max and mean over each controller state publish window, only
+  // gathered if `controller_state_statistics` is set
+  WindowStatistics<NR_STATE_STATISTICS_SIGNALS> state_statistics_;
+  using ControllerStateStatisticsPublisher =
+      SharedRealtimePublisher<ControllerStateStatisticsMsg,
+                              rclcpp::Publisher<ControllerStateStatisticsMsg>>;
+  rclcpp::Publisher<ControllerStateStatisticsMsg>::SharedPtr
+      statistics_s_publisher_;
+  std::unique_ptr<ControllerStateStatisticsPublisher>
+      state_statistics_publisher_;
+
+  // fault state machine, its optional publisher (`ControllerMode` values)
+  // and reset service
+  FaultMonitor fault_monitor_;
+  using FaultStatePublisher =
+      SharedRealtimePublisher<FaultStateMsg, rclcpp::Publisher<FaultStateMsg>>;
+  rclcpp::Publisher<FaultStateMsg>::SharedPtr fault_s_publisher_;
+  std::unique_ptr<FaultStatePublisher> fault_state_publisher_;
+  rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr reset_fault_service_;
+  ControllerMode published_mode_ = ControllerMode::RUNNING;
+  bool is_mode_published_ = false;
+  // set if the last topic reference timed out
+  bool reference_stale_ = false;
+  // age of the topic reference set in this cycle, negative if none was set
+  std::chrono::nanoseconds topic_reference_age_{-1};
+
+  // non-RT publisher of the reference age histograms in `metrics_`
+  rclcpp::Publisher<ReferenceAgeHistogramMsg>::SharedPtr
+      reference_age_publisher_;
+  rclcpp::TimerBase::SharedPtr reference_age_timer_;
 
   // override methods from ChainableControllerInterface
   std::vector<hardware_interface::CommandInterface>
@@ -130,14 +240,75 @@ protected:
 
   Odometry odometry_;
 
+  // wheel velocities from positions, if `velocity_estimation.enable` is set
+  WheelVelocityEstimator velocity_estimator_;
+
+  // drops optional stages when cycles overrun `load_shedding.cycle_budget`
+  LoadShedder load_shedder_;
+
+  // throttles integration and publishing while the base is parked
+  IdleDetector idle_detector_;
+
+  // configured processing of the reference before the inverse kinematics
+  ReferencePipeline reference_pipeline_;
+
+  // corrects the commanded yaw rate by the measured one, if
+  // `yaw_rate_feedback.enable` is set; measured by the state interface after
+  // the wheels if `yaw_rate_from_imu_`, else by the odometry
+  YawRateController yaw_rate_controller_;
+  bool yaw_rate_from_imu_ = false;
+
+  // optional archive of every `telemetry_archive.decimation`-th cycle
+  std::unique_ptr<TelemetryRecorder> telemetry_recorder_;
+  std::size_t telemetry_cycle_ = 0;
+
+  // counters of the update loop and their optional exporter, which reads
+  // them and the load shedder and fault monitor counters from its thread
+  ControllerMetrics metrics_;
+  std::unique_ptr<MetricsExporter> metrics_exporter_;
+
+  // optional raw socket input writing into `input_ref_`, declared last so its
+  // thread is stopped before the other members are destroyed
+  std::unique_ptr<ReferenceSocketListener> ref_socket_listener_;
+
 private:
   // callback for topic interface
   MECANUM_DRIVE_CONTROLLER_LOCAL
   void reference_callback(const std::shared_ptr<ControllerReferenceMsg> msg);
 
-  double velocity_in_center_frame_linear_x_;  // [m/s]
-  double velocity_in_center_frame_linear_y_;  // [m/s]
-  double velocity_in_center_frame_angular_z_; // [rad/s]
+  // callback for raw socket interface
+  MECANUM_DRIVE_CONTROLLER_LOCAL
+  void socket_reference_callback(const ReferenceFrame &frame);
+
+  // callback for obstacle distances topic
+  MECANUM_DRIVE_CONTROLLER_LOCAL
+  void obstacle_distances_callback(
+      const std::shared_ptr<ObstacleDistancesMsg> msg);
+
+  // stores the latest map->odom correction for the RT loop
+  MECANUM_DRIVE_CONTROLLER_LOCAL
+  void map_correction_callback(const std::shared_ptr<MapCorrectionMsg> msg);
+
+  // publishes the odometry pose composed with the latest map correction,
+  // only the correction is taken while publishing is not allowed
+  MECANUM_DRIVE_CONTROLLER_LOCAL
+  void publish_map_pose(const rclcpp::Time &time, bool is_publish_allowed);
+
+  // caps the reference velocity so the robot can stop before obstacles
+  MECANUM_DRIVE_CONTROLLER_LOCAL
+  void apply_obstacle_speed_limit(const rclcpp::Time &time,
+                                  const rclcpp::Duration &period,
+                                  double &linear_x, double &linear_y);
+
+  // number of wheels whose interfaces are read and written, set on activate
+  size_t nr_wheels_ = 0;
+  // commands written to the wheels in the current or last cycle
+  alignas(64) CoupledWheelVelocities wheel_commands_{};
+
+  // geometry used by the inverse kinematics, set on configure
+  MecanumKinematicsParams kinematics_params_;
+  // IK and least-squares FK of both bases, used if `coupled.enable`
+  CoupledKinematics coupled_kinematics_;
 };
 
 }  // namespace mecanum_drive_controller
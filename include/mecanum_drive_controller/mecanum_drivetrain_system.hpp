@@ -0,0 +1,82 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__MECANUM_DRIVETRAIN_SYSTEM_HPP_
+#define MECANUM_DRIVE_CONTROLLER__MECANUM_DRIVETRAIN_SYSTEM_HPP_
+
+#include <array>
+#include <vector>
+
+#include "hardware_interface/system_interface.hpp"
+#include "mecanum_drive_controller/drivetrain_model.hpp"
+#include "mecanum_drive_controller/visibility_control.h"
+#include "rclcpp/duration.hpp"
+#include "rclcpp/time.hpp"
+#include "rclcpp_lifecycle/state.hpp"
+
+namespace mecanum_drive_controller {
+/// \brief Simulated mecanum drivetrain for closed-loop tests and benchmarks
+/// of the controller without real hardware.
+///
+/// Expects four joints ordered front left, front right, rear right, rear
+/// left, each with a velocity command interface. Every joint exports
+/// position and velocity state interfaces from the simulated encoders. The
+/// ground-truth pose of the base is exported as `<name>_ground_truth/x`,
+/// `/y` and `/rz` state interfaces for accuracy measurements.
+///
+/// Hardware parameters (all optional, 0 disables an effect):
+/// `wheels_radius`, `sum_of_robot_center_projection_on_X_Y_axis` (geometry
+/// of the ground-truth motion, default 0.05 and 0.5), `time_constant` [s],
+/// `max_velocity` [rad/s], `encoder_resolution` [ticks/rev],
+/// `command_delay` [s] and `slip_ratio` [0, 1), which a joint parameter of
+/// the same name overrides for that wheel.
+class MecanumDrivetrainSystem : public hardware_interface::SystemInterface {
+public:
+  MECANUM_DRIVE_CONTROLLER_PUBLIC
+  hardware_interface::CallbackReturn
+  on_init(const hardware_interface::HardwareInfo &info) override;
+
+  MECANUM_DRIVE_CONTROLLER_PUBLIC
+  std::vector<hardware_interface::StateInterface>
+  export_state_interfaces() override;
+
+  MECANUM_DRIVE_CONTROLLER_PUBLIC
+  std::vector<hardware_interface::CommandInterface>
+  export_command_interfaces() override;
+
+  MECANUM_DRIVE_CONTROLLER_PUBLIC
+  hardware_interface::CallbackReturn
+  on_activate(const rclcpp_lifecycle::State &previous_state) override;
+
+  MECANUM_DRIVE_CONTROLLER_PUBLIC
+  hardware_interface::return_type read(const rclcpp::Time &time,
+                                       const rclcpp::Duration &period) override;
+
+  MECANUM_DRIVE_CONTROLLER_PUBLIC
+  hardware_interface::return_type
+  write(const rclcpp::Time &time, const rclcpp::Duration &period) override;
+
+private:
+  DrivetrainModel model_;
+
+  // storage of the exported interfaces
+  WheelVelocities commands_{};
+  WheelVelocities positions_{};
+  WheelVelocities velocities_{};
+  std::array<double, 3> ground_truth_{};
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__MECANUM_DRIVETRAIN_SYSTEM_HPP_
@@ -0,0 +1,84 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__METRICS_EXPORTER_HPP_
+#define MECANUM_DRIVE_CONTROLLER__METRICS_EXPORTER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace mecanum_drive_controller {
+/// \brief Exports metrics text from a non-RT thread, either by periodically
+/// rewriting a file (e.g. for the node exporter's textfile collector) or by
+/// answering HTTP GET requests on 127.0.0.1.
+class MetricsExporter {
+public:
+  enum class Type { FILE, HTTP };
+
+  /// Renders the current metrics, called from the exporter thread
+  using Renderer = std::function<std::string()>;
+
+  MetricsExporter();
+  ~MetricsExporter();
+
+  MetricsExporter(const MetricsExporter &) = delete;
+  MetricsExporter &operator=(const MetricsExporter &) = delete;
+
+  /// \param type Export target
+  /// \param file_path File replaced atomically every `period`, for FILE
+  /// \param http_port Port on 127.0.0.1, 0 for an ephemeral one, for HTTP
+  /// \param period Rewrite period of the file
+  /// \param renderer Renders the metrics
+  /// \return false if the file or socket cannot be used, see `error()`
+  bool start(const Type type, const std::string &file_path,
+             const std::uint16_t http_port,
+             const std::chrono::milliseconds period, Renderer renderer);
+
+  /// \brief Stops the thread, a file is written a last time
+  void stop();
+
+  /// \return bound HTTP port, useful with an ephemeral port
+  std::uint16_t http_port() const { return http_port_; }
+
+  /// \return number of written files or answered requests
+  std::uint64_t export_count() const {
+    return export_count_.load(std::memory_order_relaxed);
+  }
+
+  const std::string &error() const { return error_; }
+
+private:
+  bool write_file();
+  void run_file();
+  void run_http();
+
+  Type type_;
+  std::string file_path_;
+  std::chrono::milliseconds period_;
+  Renderer renderer_;
+  int fd_;
+  std::uint16_t http_port_;
+  std::string error_;
+  std::thread thread_;
+  std::atomic<bool> running_;
+  std::atomic<std::uint64_t> export_count_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__METRICS_EXPORTER_HPP_
@@ -0,0 +1,91 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__OBSTACLE_SPEED_LIMIT_HPP_
+#define MECANUM_DRIVE_CONTROLLER__OBSTACLE_SPEED_LIMIT_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace mecanum_drive_controller {
+/// \brief Free distance to the closest obstacle per motion direction of the
+/// base frame [m]. NaN means "no obstacle known" in that direction.
+struct ObstacleDistances {
+  /// Receive time [ns]
+  std::int64_t stamp_nanoseconds = 0;
+
+  double front = std::numeric_limits<double>::quiet_NaN(); // +x
+  double rear = std::numeric_limits<double>::quiet_NaN();  // -x
+  double left = std::numeric_limits<double>::quiet_NaN();  // +y
+  double right = std::numeric_limits<double>::quiet_NaN(); // -y
+};
+
+/// \brief Largest speed from which the robot still stops within `distance`.
+///
+/// Solves v * reaction_time + v^2 / (2 * deceleration) = distance for v.
+/// \param distance Free distance [m], NaN means unlimited
+/// \param deceleration Guaranteed deceleration [m/s^2], has to be > 0
+/// \param reaction_time Time before braking starts [s]
+/// \return speed limit [m/s]
+inline double braking_distance_speed_limit(const double distance,
+                                           const double deceleration,
+                                           const double reaction_time) {
+  if (std::isnan(distance)) {
+    return std::numeric_limits<double>::infinity();
+  }
+  if (distance <= 0.0) {
+    return 0.0;
+  }
+  const double a_t = deceleration * reaction_time;
+  return std::sqrt(a_t * a_t + 2.0 * deceleration * distance) - a_t;
+}
+
+/// \brief Caps a base frame velocity so the robot can stop before the
+/// obstacles in its direction of motion.
+/// \param distances Obstacle distances
+/// \param deceleration_x Deceleration along x [m/s^2]
+/// \param deceleration_y Deceleration along y [m/s^2]
+/// \param stop_margin Distance kept free in front of obstacles [m]
+/// \param reaction_time Time before braking starts [s]
+/// \param linear_x Velocity along x [m/s], limited in place
+/// \param linear_y Velocity along y [m/s], limited in place
+inline void limit_velocity_by_obstacle_distances(
+    const ObstacleDistances &distances, const double deceleration_x,
+    const double deceleration_y, const double stop_margin,
+    const double reaction_time, double &linear_x, double &linear_y) {
+  if (linear_x > 0.0) {
+    linear_x = std::min(linear_x, braking_distance_speed_limit(
+                                      distances.front - stop_margin,
+                                      deceleration_x, reaction_time));
+  } else if (linear_x < 0.0) {
+    linear_x = std::max(linear_x, -braking_distance_speed_limit(
+                                      distances.rear - stop_margin,
+                                      deceleration_x, reaction_time));
+  }
+  if (linear_y > 0.0) {
+    linear_y = std::min(linear_y, braking_distance_speed_limit(
+                                      distances.left - stop_margin,
+                                      deceleration_y, reaction_time));
+  } else if (linear_y < 0.0) {
+    linear_y = std::max(linear_y, -braking_distance_speed_limit(
+                                      distances.right - stop_margin,
+                                      deceleration_y, reaction_time));
+  }
+}
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__OBSTACLE_SPEED_LIMIT_HPP_
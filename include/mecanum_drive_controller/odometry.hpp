@@ -17,13 +17,36 @@
 #ifndef MECANUM_DRIVE_CONTROLLER__ODOMETRY_HPP_
 #define MECANUM_DRIVE_CONTROLLER__ODOMETRY_HPP_
 
+#include <array>
+#include <cstdint>
+
 #include "geometry_msgs/msg/twist.hpp"
+#include "mecanum_drive_controller/kinematics.hpp"
+#include "mecanum_drive_controller/seqlock.hpp"
 #include "realtime_tools/realtime_buffer.h"
 #include "realtime_tools/realtime_publisher.h"
 
 #define PLANAR_POINT_DIM 3
 
 namespace mecanum_drive_controller {
+/// \brief Consistent copy of the odometry state, published after each update
+struct OdometrySnapshot {
+  /// Time of the last integrated sample [ns]
+  std::int64_t stamp_nanoseconds = 0;
+
+  double x = 0.0;  // [m]
+  double y = 0.0;  // [m]
+  double rz = 0.0; // [rad]
+
+  double vx = 0.0; // [m/s]
+  double vy = 0.0; // [m/s]
+  double wz = 0.0; // [rad/s]
+
+  /// Diagonals of the 6x6 pose and twist covariance matrices
+  std::array<double, 6> pose_covariance_diagonal{};
+  std::array<double, 6> twist_covariance_diagonal{};
+};
+
 /// \brief The Odometry class handles odometry readings
 /// (2D pose and velocity with related timestamp)
 class Odometry {
@@ -38,6 +61,7 @@ public:
 
   /// \brief Initialize the odometry
   /// \param time Current time
+  /// \param base_frame_offset Base frame offset wrt center frame [x, y, theta]
   void init(const rclcpp::Time &time,
             std::array<double, PLANAR_POINT_DIM> base_frame_offset);
 
@@ -46,28 +70,45 @@ public:
   /// \param wheel_rear_left_vel  Wheel velocity [rad/s]
   /// \param wheel_rear_right_vel  Wheel velocity [rad/s]
   /// \param wheel_front_right_vel  Wheel velocity [rad/s]
-  /// \param time      Current time
+  /// \param dt      Time step since the last update [s]
+  /// \param stamp_nanoseconds Time of the wheel velocities, stamps the
+  /// snapshot [ns]
   /// \return true if the odometry is actually updated
   bool update(const double wheel_front_left_vel,
               const double wheel_rear_left_vel,
               const double wheel_rear_right_vel,
-              const double wheel_front_right_vel, const double dt);
+              const double wheel_front_right_vel, const double dt,
+              const std::int64_t stamp_nanoseconds);
+
+  /// \brief Updates the odometry class with a body twist computed elsewhere,
+  /// e.g. the fused twist of coupled bases
+  /// \param twist Body twist of the base frame
+  /// \param dt Time step since the last update [s]
+  /// \param stamp_nanoseconds Time of the twist, stamps the snapshot [ns]
+  /// \return true if the odometry is actually updated
+  bool updateFromTwist(const BodyTwist &twist, const double dt,
+                       const std::int64_t stamp_nanoseconds);
 
   /// \return position (x component) [m]
-  double getX() const { return position_x_in_base_frame_; }
+  double getX() const { return pose_.x; }
   /// \return position (y component) [m]
-  double getY() const { return position_y_in_base_frame_; }
+  double getY() const { return pose_.y; }
   /// \return orientation (z component) [m]
-  double getRz() const { return orientation_z_in_base_frame_; }
+  double getRz() const { return pose_.rz; }
   /// \return body velocity of the base frame (linear x component) [m/s]
-  double getVx() const { return velocity_in_base_frame_linear_x; }
+  double getVx() const { return twist_.linear_x; }
   /// \return body velocity of the base frame (linear y component) [m/s]
-  double getVy() const { return velocity_in_base_frame_linear_y; }
+  double getVy() const { return twist_.linear_y; }
   /// \return body velocity of the base frame (angular z component) [m/s]
-  double getWz() const {
-    return velocity_in_base_frame_angular_z;
-    ;
-  }
+  double getWz() const { return twist_.angular_z; }
+
+  /// \brief Returns the state published by the last `update()`.
+  /// Safe to call from any thread, never blocks the updating thread.
+  OdometrySnapshot getSnapshot() const { return snapshot_.load(); }
+
+  /// \brief Sets the covariance diagonals carried by the snapshot
+  void setCovarianceDiagonals(const std::array<double, 6> &pose_covariance,
+                              const std::array<double, 6> &twist_covariance);
 
   /// \brief Sets the wheels parameters: mecanum geometric param and radius
   /// \param sum_of_robot_center_projection_on_X_Y_axis Wheels geometric param
@@ -77,27 +118,25 @@ public:
                        const double wheels_radius);
 
 private:
-  /// Current timestamp:
-  rclcpp::Time timestamp_;
-
-  /// Reference frame (wrt to center frame). [x, y, theta]
-  std::array<double, PLANAR_POINT_DIM> base_frame_offset_;
-
-  /// Current pose:
-  double position_x_in_base_frame_;    // [m]
-  double position_y_in_base_frame_;    // [m]
-  double orientation_z_in_base_frame_; // [rad]
-
-  double velocity_in_base_frame_linear_x;  // [m/s]
-  double velocity_in_base_frame_linear_y;  // [m/s]
-  double velocity_in_base_frame_angular_z; // [rad/s]
-
-  /// Wheels kinematic parameters [m]:
-  /// lx and ly represent the distance from the robot's center to the wheels
-  /// projected on the x and y axis with origin at robots center respectively,
-  /// sum_of_robot_center_projection_on_X_Y_axis_ = lx+ly
-  double sum_of_robot_center_projection_on_X_Y_axis_;
-  double wheels_radius_; // [m]
+  /// Stores the current state into `snapshot_`
+  void publishSnapshot();
+
+  /// Time of the last integrated sample [ns]
+  std::int64_t timestamp_nanoseconds_;
+
+  /// Wheels kinematic parameters and reference frame (wrt to center frame)
+  MecanumKinematicsParams kinematics_params_;
+
+  /// Current pose, in the odometry frame
+  Pose2D pose_;
+  /// Current body twist of the base frame
+  BodyTwist twist_;
+
+  std::array<double, 6> pose_covariance_diagonal_;
+  std::array<double, 6> twist_covariance_diagonal_;
+
+  /// State shared with non-RT readers
+  SeqLock<OdometrySnapshot> snapshot_;
 };
 
 } // namespace mecanum_drive_controller
@@ -0,0 +1,44 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__PROCESS_USAGE_HPP_
+#define MECANUM_DRIVE_CONTROLLER__PROCESS_USAGE_HPP_
+
+#include <cstdint>
+
+namespace mecanum_drive_controller {
+/// \brief Heap in use and threads of the process, or differences of them
+struct ProcessUsage {
+  std::int64_t heap_bytes = 0;
+  std::int64_t threads = 0;
+};
+
+/// \brief Samples the heap in use (glibc only, else 0) and the number of
+/// threads of this process, not RT-safe
+///
+/// Differences of two samples attribute memory and threads to the code run
+/// in between; allocations of other threads meanwhile are included.
+ProcessUsage sample_process_usage();
+
+inline ProcessUsage operator-(const ProcessUsage &a, const ProcessUsage &b) {
+  return {a.heap_bytes - b.heap_bytes, a.threads - b.threads};
+}
+
+inline ProcessUsage operator+(const ProcessUsage &a, const ProcessUsage &b) {
+  return {a.heap_bytes + b.heap_bytes, a.threads + b.threads};
+}
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__PROCESS_USAGE_HPP_
@@ -0,0 +1,101 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__REFERENCE_PIPELINE_HPP_
+#define MECANUM_DRIVE_CONTROLLER__REFERENCE_PIPELINE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "mecanum_drive_controller/kinematics.hpp"
+
+namespace mecanum_drive_controller {
+/// Stages of the reference pipeline
+enum class ReferenceStage : std::size_t { SCALE = 0, LIMIT, DEADBAND, FRAME };
+static constexpr std::size_t NR_REFERENCE_STAGES = 4;
+
+/// \brief Parameters of the reference pipeline stages, per component in the
+/// order linear x, linear y, angular z
+struct ReferencePipelineParams {
+  /// Factors of the `scale` stage
+  std::array<double, 3> scale{{1.0, 1.0, 1.0}};
+  /// Maximum magnitudes of the `limit` stage, 0 leaves a component unlimited
+  /// [m/s, m/s, rad/s]
+  std::array<double, 3> limit{{0.0, 0.0, 0.0}};
+  /// Magnitudes below which the `deadband` stage zeroes a component
+  /// [m/s, m/s, rad/s]
+  std::array<double, 3> deadband{{0.0, 0.0, 0.0}};
+  /// Pose of the reference frame in the base frame for the `frame` stage
+  Pose2D frame;
+};
+
+/// \brief Ordered stages processing the body twist reference before the
+/// inverse kinematics.
+///
+/// The stages are compiled at configure time into a fixed array holding only
+/// the kinds of the configured stages. Processing switches on the kind, so
+/// the stages are called directly and inlined; it neither dispatches
+/// indirectly, allocates nor branches on disabled stages. Stages may appear
+/// at most once.
+class ReferencePipeline {
+public:
+  static constexpr std::size_t MAX_STAGES = NR_REFERENCE_STAGES;
+
+  ReferencePipeline();
+
+  /// \param stages Stage names in processing order: "scale", "limit",
+  /// "deadband" or "frame"
+  /// \param params Parameters of the stages
+  /// \return false if a stage is unknown or repeated, see `error()`; the
+  /// pipeline is then empty
+  bool configure(const std::vector<std::string> &stages,
+                 const ReferencePipelineParams &params);
+
+  /// \return number of configured stages
+  std::size_t size() const { return size_; }
+
+  /// \return kind of the i-th configured stage
+  ReferenceStage stage(const std::size_t i) const { return kinds_[i]; }
+
+  /// \brief Applies the stages in order, RT-safe
+  void process(BodyTwist &twist) const;
+
+  /// \return stage name as used by `configure()`
+  static const char *to_string(const ReferenceStage stage);
+
+  const std::string &error() const { return error_; }
+
+  /// Stage parameters prepared for processing
+  struct Coefficients {
+    std::array<double, 3> scale;
+    std::array<double, 3> limit;
+    std::array<double, 3> deadband;
+    double frame_x;
+    double frame_y;
+    double frame_cos;
+    double frame_sin;
+  };
+
+private:
+  Coefficients coefficients_;
+  std::array<ReferenceStage, MAX_STAGES> kinds_;
+  std::size_t size_;
+  std::string error_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__REFERENCE_PIPELINE_HPP_
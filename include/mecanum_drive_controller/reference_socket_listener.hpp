@@ -0,0 +1,119 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__REFERENCE_SOCKET_LISTENER_HPP_
+#define MECANUM_DRIVE_CONTROLLER__REFERENCE_SOCKET_LISTENER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace mecanum_drive_controller {
+/// \brief Body twist reference received over a raw socket
+struct ReferenceFrame {
+  std::uint32_t sequence = 0;
+  /// Stamp of the reference [ns], zero means "use the receive time"
+  std::int64_t stamp_nanoseconds = 0;
+  double linear_x = 0.0;  // [m/s]
+  double linear_y = 0.0;  // [m/s]
+  double angular_z = 0.0; // [rad/s]
+};
+
+/// Wire layout, all fields little-endian:
+///  - [0, 4)   uint32 magic `REFERENCE_FRAME_MAGIC`
+///  - [4, 8)   uint32 sequence number
+///  - [8, 16)  int64 stamp [ns]
+///  - [16, 40) 3 x float64 linear x, linear y, angular z
+///  - [40, 44) uint32 CRC-32 (IEEE 802.3, as zlib's crc32) of bytes [0, 40)
+///  - [44, 48) uint32 reserved, zero
+static constexpr std::size_t REFERENCE_FRAME_SIZE = 48;
+static constexpr std::uint32_t REFERENCE_FRAME_MAGIC = 0x4652444d; // "MDRF"
+
+/// \brief Serializes `frame` into the wire layout
+void encode_reference_frame(
+    const ReferenceFrame &frame,
+    std::array<std::uint8_t, REFERENCE_FRAME_SIZE> &buffer);
+
+/// \brief Parses a datagram
+/// \return false if size, magic or checksum do not match
+bool decode_reference_frame(const std::uint8_t *data, const std::size_t size,
+                            ReferenceFrame &frame);
+
+/// \brief Receives `ReferenceFrame`s on a Unix-domain datagram socket or a
+/// localhost UDP socket in its own (non-RT) thread.
+///
+/// Frames whose sequence number is not newer than the last accepted one are
+/// dropped, sequence number zero marks a restarted sender and is always
+/// accepted.
+class ReferenceSocketListener {
+public:
+  using Callback = std::function<void(const ReferenceFrame &)>;
+
+  enum class Type { UNIX, UDP };
+
+  ReferenceSocketListener();
+  ~ReferenceSocketListener();
+
+  ReferenceSocketListener(const ReferenceSocketListener &) = delete;
+  ReferenceSocketListener &operator=(const ReferenceSocketListener &) = delete;
+
+  /// \brief Opens the socket and starts the receiving thread
+  /// \param type Socket family
+  /// \param unix_path Socket path, used for `Type::UNIX`. A stale socket
+  /// there is replaced, any other existing file is an error.
+  /// \param udp_port Port bound on 127.0.0.1, used for `Type::UDP`
+  /// \param callback Called from the receiving thread for accepted frames
+  /// \return false if the socket could not be opened, see `error()`
+  bool start(const Type type, const std::string &unix_path,
+             const std::uint16_t udp_port, Callback callback);
+
+  /// \brief Stops the receiving thread and closes the socket
+  void stop();
+
+  /// \return description of the last `start()` failure
+  const std::string &error() const { return error_; }
+
+  /// \return number of accepted frames
+  std::uint64_t accepted_count() const {
+    return accepted_count_.load(std::memory_order_relaxed);
+  }
+
+  /// \return number of malformed or out-of-order frames
+  std::uint64_t rejected_count() const {
+    return rejected_count_.load(std::memory_order_relaxed);
+  }
+
+private:
+  void run();
+
+  int fd_;
+  std::string unix_path_;
+  std::string error_;
+  Callback callback_;
+  std::thread thread_;
+  std::atomic<bool> running_;
+
+  bool has_sequence_;
+  std::uint32_t last_sequence_;
+  std::atomic<std::uint64_t> accepted_count_;
+  std::atomic<std::uint64_t> rejected_count_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__REFERENCE_SOCKET_LISTENER_HPP_
@@ -0,0 +1,98 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__SEQLOCK_HPP_
+#define MECANUM_DRIVE_CONTROLLER__SEQLOCK_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace mecanum_drive_controller {
+/// \brief Single-writer / multi-reader sequence lock.
+///
+/// The writer (RT thread) never blocks and never allocates. Readers copy the
+/// value out and retry if a write happened concurrently, so they always
+/// observe a consistent value. The payload is stored as relaxed atomic words
+/// to keep the concurrent copy free of data races.
+template <typename T> class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock payload has to be trivially copyable");
+
+public:
+  SeqLock() : sequence_(0) {
+    for (auto &word : data_) {
+      word.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  /// \brief Publishes a new value. Must only be called from one thread.
+  void store(const T &value) noexcept {
+    std::array<std::uint64_t, NR_WORDS> words{};
+    std::memcpy(words.data(), &value, sizeof(T));
+
+    const std::uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < NR_WORDS; ++i) {
+      data_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  /// \brief Tries to read a consistent value once.
+  /// \return false if a write was in progress, `value` is then unchanged.
+  bool try_load(T &value) const noexcept {
+    const std::uint64_t before = sequence_.load(std::memory_order_acquire);
+    if (before & 1u) {
+      return false;
+    }
+    std::array<std::uint64_t, NR_WORDS> words;
+    for (std::size_t i = 0; i < NR_WORDS; ++i) {
+      words[i] = data_[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence_.load(std::memory_order_relaxed) != before) {
+      return false;
+    }
+    std::memcpy(&value, words.data(), sizeof(T));
+    return true;
+  }
+
+  /// \brief Reads a consistent value, retrying while the writer is active.
+  T load() const noexcept {
+    T value;
+    while (!try_load(value)) {
+    }
+    return value;
+  }
+
+  /// \return number of completed writes
+  std::uint64_t version() const noexcept {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+
+private:
+  static constexpr std::size_t NR_WORDS =
+      (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+  std::atomic<std::uint64_t> sequence_;
+  std::array<std::atomic<std::uint64_t>, NR_WORDS> data_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__SEQLOCK_HPP_
@@ -0,0 +1,137 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__SHARED_REALTIME_PUBLISHER_HPP_
+#define MECANUM_DRIVE_CONTROLLER__SHARED_REALTIME_PUBLISHER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mecanum_drive_controller {
+/// \brief Message handed over from the RT thread to the shared publishing
+/// thread.
+///
+/// The slot is FREE for the RT thread, LOCKED while one side accesses the
+/// message and PENDING while a message waits for publishing.
+class PublishSlot {
+public:
+  virtual ~PublishSlot() = default;
+
+  /// \brief Publishes the pending message, called by the publishing thread
+  /// \return true if a message was published
+  bool publish_pending();
+
+protected:
+  enum State : int { FREE = 0, LOCKED, PENDING };
+
+  /// \brief Locks a free slot, RT-safe
+  bool try_acquire() {
+    int expected = FREE;
+    return state_.compare_exchange_strong(expected, LOCKED,
+                                          std::memory_order_acquire);
+  }
+
+  /// \brief Unlocks the slot, PENDING hands the message over
+  void release(const State next) {
+    state_.store(next, std::memory_order_release);
+  }
+
+  virtual void publish_message() = 0;
+
+private:
+  std::atomic<int> state_{FREE};
+};
+
+/// \brief One thread publishing the pending messages of all slots of the
+/// process, instead of one thread per publisher.
+class SharedPublisherThread {
+public:
+  /// \return the thread of this process, started by its first user and
+  /// stopped once the last user released it
+  static std::shared_ptr<SharedPublisherThread> acquire();
+
+  ~SharedPublisherThread();
+
+  SharedPublisherThread(const SharedPublisherThread &) = delete;
+  SharedPublisherThread &operator=(const SharedPublisherThread &) = delete;
+
+  /// \brief Publishes the pending messages of `slot` from now on, not RT-safe
+  void add(PublishSlot *slot);
+
+  /// \brief Stops publishing `slot`, which is not accessed anymore once this
+  /// returns, not RT-safe
+  void remove(PublishSlot *slot);
+
+private:
+  SharedPublisherThread();
+
+  void run();
+
+  std::mutex mutex_;
+  std::vector<PublishSlot *> slots_;
+  std::atomic<bool> running_;
+  std::thread thread_;
+};
+
+/// \brief Realtime publisher without a thread of its own, with the interface
+/// of `realtime_tools::RealtimePublisher`: the RT thread fills `msg_` after a
+/// successful `trylock()` and hands it over by `unlockAndPublish()`.
+/// \tparam PublisherT Publisher with `publish(const MessageT &)`
+template <class MessageT, class PublisherT>
+class SharedRealtimePublisher : public PublishSlot {
+public:
+  explicit SharedRealtimePublisher(std::shared_ptr<PublisherT> publisher)
+      : publisher_(std::move(publisher)),
+        thread_(SharedPublisherThread::acquire()) {
+    thread_->add(this);
+  }
+
+  ~SharedRealtimePublisher() override { thread_->remove(this); }
+
+  SharedRealtimePublisher(const SharedRealtimePublisher &) = delete;
+  SharedRealtimePublisher &operator=(const SharedRealtimePublisher &) = delete;
+
+  /// \return true if `msg_` may be written, false while the previous message
+  /// is still pending, RT-safe
+  bool trylock() { return try_acquire(); }
+
+  /// \brief Waits until `msg_` may be written, not RT-safe
+  void lock() {
+    while (!try_acquire()) {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+
+  void unlock() { release(FREE); }
+
+  /// \brief Unlocks and publishes `msg_` from the shared thread, RT-safe
+  void unlockAndPublish() { release(PENDING); }
+
+  MessageT msg_;
+
+private:
+  void publish_message() override { publisher_->publish(msg_); }
+
+  std::shared_ptr<PublisherT> publisher_;
+  std::shared_ptr<SharedPublisherThread> thread_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__SHARED_REALTIME_PUBLISHER_HPP_
@@ -0,0 +1,70 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__SPSC_QUEUE_HPP_
+#define MECANUM_DRIVE_CONTROLLER__SPSC_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace mecanum_drive_controller {
+/// \brief Bounded wait-free single-producer / single-consumer queue.
+///
+/// Memory is allocated once in the constructor, `push()` and `pop()` never
+/// allocate, so the producer can be the RT thread.
+template <typename T> class SpscQueue {
+public:
+  explicit SpscQueue(const std::size_t capacity)
+      : buffer_(capacity + 1), head_(0), tail_(0) {}
+
+  /// \return false if the queue is full, `value` is then dropped
+  bool push(const T &value) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    const std::size_t next = increment(tail);
+    if (next == head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    buffer_[tail] = value;
+    tail_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /// \return false if the queue is empty
+  bool pop(T &value) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    value = buffer_[head];
+    head_.store(increment(head), std::memory_order_release);
+    return true;
+  }
+
+  std::size_t capacity() const { return buffer_.size() - 1; }
+
+private:
+  std::size_t increment(const std::size_t index) const {
+    return index + 1 == buffer_.size() ? 0 : index + 1;
+  }
+
+  std::vector<T> buffer_;
+  // separate cache lines, so producer and consumer do not share one
+  alignas(64) std::atomic<std::size_t> head_;
+  alignas(64) std::atomic<std::size_t> tail_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__SPSC_QUEUE_HPP_
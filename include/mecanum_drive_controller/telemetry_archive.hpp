@@ -0,0 +1,171 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__TELEMETRY_ARCHIVE_HPP_
+#define MECANUM_DRIVE_CONTROLLER__TELEMETRY_ARCHIVE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mecanum_drive_controller {
+/// Channels of a telemetry sample, wheels sorted as in the controller
+enum TelemetryChannel : std::size_t {
+  FRONT_LEFT_STATE = 0,
+  FRONT_RIGHT_STATE,
+  REAR_RIGHT_STATE,
+  REAR_LEFT_STATE,
+  FRONT_LEFT_COMMAND,
+  FRONT_RIGHT_COMMAND,
+  REAR_RIGHT_COMMAND,
+  REAR_LEFT_COMMAND,
+  ODOMETRY_X,
+  ODOMETRY_Y,
+  ODOMETRY_RZ,
+  ODOMETRY_VX,
+  ODOMETRY_VY,
+  ODOMETRY_WZ,
+  NR_TELEMETRY_CHANNELS
+};
+
+/// \return name of `channel`, e.g. for CSV headers
+const char *telemetry_channel_name(const std::size_t channel);
+
+/// \brief One control cycle: wheel states, wheel commands and odometry
+struct TelemetrySample {
+  std::int64_t stamp_nanoseconds = 0;
+  std::array<double, NR_TELEMETRY_CHANNELS> values{};
+};
+
+using TelemetryQuantization = std::array<double, NR_TELEMETRY_CHANNELS>;
+
+/// \return default quantization steps: 1e-4 rad/s for wheels, 1e-5 m and
+/// 1e-6 rad for the pose, 1e-4 m/s and rad/s for the twist
+TelemetryQuantization default_telemetry_quantization();
+
+/// \brief Location and time range of an encoded block
+struct TelemetryBlockInfo {
+  std::uint64_t offset = 0;
+  std::int64_t first_stamp_nanoseconds = 0;
+  std::int64_t last_stamp_nanoseconds = 0;
+  std::uint32_t sample_count = 0;
+};
+
+/// \brief Writes the compressed telemetry archive format.
+///
+/// Layout:
+///  - file header: magic, version, channel count, quantization steps
+///  - blocks: header (magic, sample count, first/last stamp, payload size,
+///    CRC-32 of payload) and payload. Each block is decodable on its own:
+///    per sample a zigzag varint of the stamp delta-of-delta, a varint NaN
+///    mask and per channel a zigzag varint of the quantized value delta.
+///  - block index and trailer, written on `close()`. Archives of crashed
+///    writers have no index and are scanned block by block instead. The
+///    scan verifies the CRC of each block and searches the next block magic
+///    after a corrupted one.
+///
+/// Not RT-safe, use `TelemetryRecorder` to feed it from the control loop.
+class TelemetryArchiveWriter {
+public:
+  TelemetryArchiveWriter();
+  ~TelemetryArchiveWriter();
+
+  /// \param path File to create, an existing file is overwritten
+  /// \param quantization Quantization step per channel, values are stored
+  /// as multiples of it
+  /// \param block_samples Number of samples per block
+  /// \return false on I/O errors, see `error()`
+  bool open(const std::string &path, const TelemetryQuantization &quantization,
+            const std::size_t block_samples);
+
+  /// \brief Encodes `sample`, writes the block once it is full
+  bool append(const TelemetrySample &sample);
+
+  /// \brief Writes the pending samples as a (shorter) block
+  bool flush();
+
+  /// \brief Flushes, writes the block index and closes the file
+  bool close();
+
+  bool is_open() const { return file_.is_open(); }
+
+  const std::string &error() const { return error_; }
+
+private:
+  void start_block();
+
+  std::ofstream file_;
+  std::string error_;
+  TelemetryQuantization quantization_;
+  std::size_t block_samples_;
+  std::vector<TelemetryBlockInfo> index_;
+
+  // state of the current block
+  std::vector<std::uint8_t> payload_;
+  TelemetryBlockInfo block_;
+  std::int64_t previous_stamp_;
+  std::int64_t previous_stamp_delta_;
+  std::array<std::int64_t, NR_TELEMETRY_CHANNELS> previous_values_;
+};
+
+/// \brief Streaming reader of telemetry archives. Only the blocks
+/// overlapping the requested time range are read and decoded.
+class TelemetryArchiveReader {
+public:
+  /// \return false if the file is no telemetry archive, see `error()`
+  bool open(const std::string &path);
+
+  /// \brief Calls `callback` for every sample with a stamp in [begin, end].
+  /// Corrupted blocks are skipped and counted.
+  /// \return false on I/O errors
+  bool read(const std::int64_t begin_nanoseconds,
+            const std::int64_t end_nanoseconds,
+            const std::function<void(const TelemetrySample &)> &callback);
+
+  const std::vector<TelemetryBlockInfo> &blocks() const { return blocks_; }
+
+  /// \return false if the index was missing and blocks were scanned
+  bool has_index() const { return has_index_; }
+
+  const TelemetryQuantization &quantization() const { return quantization_; }
+
+  std::size_t corrupted_block_count() const { return corrupted_block_count_; }
+
+  const std::string &error() const { return error_; }
+
+private:
+  bool read_index(const std::uint64_t file_size);
+  /// Counts every failed block as corrupted, except a last block cut off at
+  /// the end of the file
+  void scan_blocks(const std::uint64_t file_size);
+  /// \return offset of the next block magic from `offset`, or `file_size`
+  std::uint64_t find_block_magic(std::uint64_t offset,
+                                 const std::uint64_t file_size);
+
+  std::ifstream file_;
+  std::string error_;
+  TelemetryQuantization quantization_{};
+  std::vector<TelemetryBlockInfo> blocks_;
+  std::uint64_t data_offset_ = 0;
+  bool has_index_ = false;
+  std::size_t corrupted_block_count_ = 0;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__TELEMETRY_ARCHIVE_HPP_
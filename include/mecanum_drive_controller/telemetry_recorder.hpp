@@ -0,0 +1,76 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__TELEMETRY_RECORDER_HPP_
+#define MECANUM_DRIVE_CONTROLLER__TELEMETRY_RECORDER_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "mecanum_drive_controller/spsc_queue.hpp"
+#include "mecanum_drive_controller/telemetry_archive.hpp"
+
+namespace mecanum_drive_controller {
+/// \brief Hands cycle samples from the RT thread to a writer thread which
+/// encodes them into a telemetry archive.
+class TelemetryRecorder {
+public:
+  TelemetryRecorder();
+  ~TelemetryRecorder();
+
+  TelemetryRecorder(const TelemetryRecorder &) = delete;
+  TelemetryRecorder &operator=(const TelemetryRecorder &) = delete;
+
+  /// \brief Opens the archive and starts the writer thread
+  /// \param path Archive file
+  /// \param queue_size Number of samples buffered between the threads
+  /// \param block_samples Number of samples per archive block
+  /// \return false if the archive could not be created, see `error()`
+  bool start(const std::string &path, const std::size_t queue_size,
+             const std::size_t block_samples);
+
+  /// \brief Stops the writer thread, writes pending samples and the index
+  void stop();
+
+  /// \brief Queues a sample, RT-safe
+  /// \return false if the writer is not running or the queue is full
+  bool record(const TelemetrySample &sample);
+
+  bool is_running() const { return running_.load(std::memory_order_relaxed); }
+
+  /// \return number of samples dropped on a full queue
+  std::uint64_t dropped_count() const {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+  const std::string &error() const { return error_; }
+
+private:
+  void run();
+
+  std::unique_ptr<SpscQueue<TelemetrySample>> queue_;
+  TelemetryArchiveWriter writer_;
+  std::string error_;
+  std::thread thread_;
+  std::atomic<bool> running_;
+  std::atomic<std::uint64_t> dropped_count_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__TELEMETRY_RECORDER_HPP_
@@ -0,0 +1,88 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__WHEEL_VELOCITY_ESTIMATOR_HPP_
+#define MECANUM_DRIVE_CONTROLLER__WHEEL_VELOCITY_ESTIMATOR_HPP_
+
+#include <array>
+#include <cstddef>
+
+#include "mecanum_drive_controller/kinematics.hpp"
+
+namespace mecanum_drive_controller {
+/// \brief Estimates wheel velocities by differencing encoder positions over
+/// an adaptive window.
+///
+/// At low speed a position changes by less than one encoder tick per cycle,
+/// so the window is made long enough to contain `min_displacement`; at high
+/// speed it shrinks down to `min_window` samples to keep the delay small.
+/// Positions are kept in fixed-size ring buffers, updates are O(1) and do not
+/// allocate.
+class WheelVelocityEstimator {
+public:
+  /// Longest supported window [samples]
+  static constexpr std::size_t MAX_WINDOW = 64;
+
+  WheelVelocityEstimator();
+
+  /// \param min_window Shortest differencing window [samples]
+  /// \param max_window Longest differencing window [samples], at most
+  /// `MAX_WINDOW`
+  /// \param min_displacement Displacement a window should contain, a few
+  /// encoder ticks [rad]
+  void configure(const std::size_t min_window, const std::size_t max_window,
+                 const double min_displacement);
+
+  /// \brief Forgets all positions
+  void reset();
+
+  /// \brief Adds the position of `wheel` and estimates its velocity
+  /// \param position Wheel position [rad]
+  /// \param dt Time since the previous update [s]
+  /// \return velocity [rad/s], 0 until two positions are known, NaN if
+  /// `position` is NaN (the wheel's history is then dropped)
+  double update(const std::size_t wheel, const double position,
+                const double dt);
+
+  /// \return window used by the last `update()` of `wheel` [samples]
+  std::size_t window(const std::size_t wheel) const {
+    return wheels_[wheel].window;
+  }
+
+private:
+  static constexpr std::size_t BUFFER_SIZE = MAX_WINDOW + 1;
+
+  struct Wheel {
+    std::array<double, BUFFER_SIZE> positions;
+    std::array<double, BUFFER_SIZE> times;
+    std::size_t head = 0;  // index of the newest sample
+    std::size_t count = 0; // number of valid samples
+    double time = 0.0;     // time of the newest sample [s]
+    std::size_t window = 0;
+  };
+
+  /// \return index of the sample `lag` updates before the newest one
+  static std::size_t at(const Wheel &wheel, const std::size_t lag) {
+    return (wheel.head + BUFFER_SIZE - lag) % BUFFER_SIZE;
+  }
+
+  std::size_t min_window_;
+  std::size_t max_window_;
+  double min_displacement_;
+  std::array<Wheel, NR_COUPLED_WHEELS> wheels_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__WHEEL_VELOCITY_ESTIMATOR_HPP_
@@ -0,0 +1,76 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__WINDOW_STATISTICS_HPP_
+#define MECANUM_DRIVE_CONTROLLER__WINDOW_STATISTICS_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace mecanum_drive_controller {
+/// \brief Running min, max and mean of `N` signals over a window of samples.
+///
+/// Updated incrementally in constant memory, RT-safe. NaN values are not
+/// counted; a signal without valid values in the window reports NaN.
+template <std::size_t N> class WindowStatistics {
+public:
+  WindowStatistics() { reset(); }
+
+  /// \brief Starts a new window
+  void reset() {
+    min_.fill(std::numeric_limits<double>::infinity());
+    max_.fill(-std::numeric_limits<double>::infinity());
+    sum_.fill(0.0);
+    count_.fill(0);
+  }
+
+  void add(const std::array<double, N> &values) {
+    for (std::size_t i = 0; i < N; ++i) {
+      if (std::isnan(values[i])) {
+        continue;
+      }
+      min_[i] = std::min(min_[i], values[i]);
+      max_[i] = std::max(max_[i], values[i]);
+      sum_[i] += values[i];
+      ++count_[i];
+    }
+  }
+
+  double min(const std::size_t i) const {
+    return count_[i] ? min_[i] : std::numeric_limits<double>::quiet_NaN();
+  }
+  double max(const std::size_t i) const {
+    return count_[i] ? max_[i] : std::numeric_limits<double>::quiet_NaN();
+  }
+  double mean(const std::size_t i) const {
+    return count_[i] ? sum_[i] / static_cast<double>(count_[i])
+                     : std::numeric_limits<double>::quiet_NaN();
+  }
+
+  /// \return number of valid values of signal `i` in the window
+  std::size_t count(const std::size_t i) const { return count_[i]; }
+
+private:
+  std::array<double, N> min_;
+  std::array<double, N> max_;
+  std::array<double, N> sum_;
+  std::array<std::size_t, N> count_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__WINDOW_STATISTICS_HPP_
@@ -0,0 +1,62 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MECANUM_DRIVE_CONTROLLER__YAW_RATE_CONTROLLER_HPP_
+#define MECANUM_DRIVE_CONTROLLER__YAW_RATE_CONTROLLER_HPP_
+
+namespace mecanum_drive_controller {
+/// \brief PI loop correcting the commanded yaw rate by the measured one.
+///
+/// Compensates a consistent error of the realized yaw rate, e.g. due to an
+/// inexact wheel geometry, at the control rate. The correction is added to
+/// the commanded yaw rate and limited, the integral is limited accordingly
+/// (anti-windup). All methods are RT-safe.
+class YawRateController {
+public:
+  YawRateController();
+
+  /// \brief Sets the gains and resets the state
+  /// \param kp Proportional gain
+  /// \param ki Integral gain [1/s]
+  /// \param max_correction Maximum magnitude of the correction [rad/s], zero
+  /// leaves it unlimited
+  void configure(const double kp, const double ki,
+                 const double max_correction);
+
+  /// \brief Clears the integral, e.g. when the base stops
+  void reset();
+
+  /// \param commanded Yaw rate of the reference [rad/s]
+  /// \param measured Realized yaw rate [rad/s], NaN holds the integral and
+  /// applies no correction
+  /// \param dt Time since the previous update [s]
+  /// \return corrected yaw rate to command [rad/s]
+  double update(const double commanded, const double measured,
+                const double dt);
+
+  /// \return correction of the last update [rad/s]
+  double correction() const { return correction_; }
+
+private:
+  double kp_;
+  double ki_;
+  double max_correction_;
+
+  double integral_;
+  double correction_;
+};
+
+} // namespace mecanum_drive_controller
+
+#endif // MECANUM_DRIVE_CONTROLLER__YAW_RATE_CONTROLLER_HPP_
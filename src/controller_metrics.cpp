@@ -0,0 +1,245 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/controller_metrics.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace { // utility
+
+constexpr const char *PREFIX = "mecanum_drive_controller_";
+
+const char *publisher_name(const std::size_t publisher) {
+  static constexpr const char *NAMES[] = {
+      "odometry", "controller_state", "controller_state_statistics",
+      "fault_state", "map_pose"};
+  return NAMES[publisher];
+}
+
+const char *reference_input_name(const std::size_t input) {
+  static constexpr const char *NAMES[] = {"topic"};
+  return NAMES[input];
+}
+
+const char *shed_stage_name(const std::size_t stage) {
+  static constexpr const char *NAMES[] = {"introspection", "telemetry",
+                                          "controller_state", "odometry"};
+  return NAMES[stage];
+}
+
+// escapes a label value as required by the exposition format
+std::string escape_label(const std::string &value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (const char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+class PrometheusWriter {
+public:
+  explicit PrometheusWriter(const std::string &controller)
+      : labels_("controller=\"" + escape_label(controller) + "\"") {}
+
+  void header(const char *name, const char *type, const char *help) {
+    text_ += "# HELP ";
+    text_ += PREFIX;
+    text_ += name;
+    text_ += ' ';
+    text_ += help;
+    text_ += "\n# TYPE ";
+    text_ += PREFIX;
+    text_ += name;
+    text_ += ' ';
+    text_ += type;
+    text_ += '\n';
+  }
+
+  void sample(const char *name, const std::string &extra_labels,
+              const char *value) {
+    text_ += PREFIX;
+    text_ += name;
+    text_ += '{';
+    text_ += labels_;
+    if (!extra_labels.empty()) {
+      text_ += ',';
+      text_ += extra_labels;
+    }
+    text_ += "} ";
+    text_ += value;
+    text_ += '\n';
+  }
+
+  void sample(const char *name, const std::string &extra_labels,
+              const std::uint64_t value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%" PRIu64, value);
+    sample(name, extra_labels, buffer);
+  }
+
+  void sample(const char *name, const std::string &extra_labels,
+              const double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    sample(name, extra_labels, buffer);
+  }
+
+  void counter(const char *name, const char *help, const std::uint64_t value) {
+    header(name, "counter", help);
+    sample(name, "", value);
+  }
+
+  void histogram(const char *name, const std::string &extra_labels,
+                 const mecanum_drive_controller::LatencyHistogram &histogram) {
+    const std::string bucket_name = std::string(name) + "_bucket";
+    const std::string separator = extra_labels.empty() ? "" : ",";
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < histogram.NR_BUCKETS; ++i) {
+      cumulative += histogram.bucket(i);
+      char bound[32];
+      if (i < histogram.NR_BOUNDS) {
+        std::snprintf(bound, sizeof(bound), "le=\"%g\"",
+                      1e-9 * static_cast<double>(histogram.bounds()[i]));
+      } else {
+        std::snprintf(bound, sizeof(bound), "le=\"+Inf\"");
+      }
+      sample(bucket_name.c_str(), extra_labels + separator + bound,
+             cumulative);
+    }
+    sample((std::string(name) + "_sum").c_str(), extra_labels,
+           1e-9 * static_cast<double>(histogram.sum_nanoseconds()));
+    sample((std::string(name) + "_count").c_str(), extra_labels, cumulative);
+  }
+
+  std::string &text() { return text_; }
+
+private:
+  std::string labels_;
+  std::string text_;
+};
+
+} // namespace
+
+namespace mecanum_drive_controller {
+constexpr LatencyHistogram::Bounds ControllerMetrics::CYCLE_DURATION_BOUNDS;
+constexpr LatencyHistogram::Bounds ControllerMetrics::REFERENCE_AGE_BOUNDS;
+constexpr LatencyHistogram::Bounds
+    ControllerMetrics::REFERENCE_PIPELINE_DURATION_BOUNDS;
+
+ControllerMetrics::ControllerMetrics()
+    : cycle_durations_(CYCLE_DURATION_BOUNDS),
+      reference_ages_{{LatencyHistogram(REFERENCE_AGE_BOUNDS)}},
+      reference_pipeline_durations_(REFERENCE_PIPELINE_DURATION_BOUNDS) {
+  reset();
+}
+
+void ControllerMetrics::reset() {
+  cycles_.store(0, std::memory_order_relaxed);
+  cycle_durations_.reset();
+  for (auto &reference_ages : reference_ages_) {
+    reference_ages.reset();
+  }
+  reference_pipeline_durations_.reset();
+  for (auto &dropped : dropped_publishes_) {
+    dropped.store(0, std::memory_order_relaxed);
+  }
+  reference_timeouts_.store(0, std::memory_order_relaxed);
+  invalid_wheel_states_.store(0, std::memory_order_relaxed);
+}
+
+std::string
+ControllerMetrics::render_prometheus(const std::string &controller,
+                                     const LoadShedder &load_shedder,
+                                     const FaultMonitor &fault_monitor) const {
+  PrometheusWriter writer(controller);
+
+  writer.counter("cycles_total", "Update cycles.", cycles());
+
+  writer.header("cycle_duration_seconds", "histogram",
+                "Duration of the measured update cycles.");
+  writer.histogram("cycle_duration_seconds", "", cycle_durations_);
+
+  writer.header("reference_age_seconds", "histogram",
+                "Age of the references applied to the wheels, from their "
+                "stamp to the consuming update.");
+  for (std::size_t i = 0; i < NR_REFERENCE_INPUTS; ++i) {
+    writer.histogram("reference_age_seconds",
+                     std::string("input=\"") + reference_input_name(i) + "\"",
+                     reference_ages_[i]);
+  }
+
+  writer.header("reference_pipeline_duration_seconds", "histogram",
+                "Duration of the reference pipeline in the measured update "
+                "cycles.");
+  writer.histogram("reference_pipeline_duration_seconds", "",
+                   reference_pipeline_durations_);
+
+  writer.counter("overruns_total",
+                 "Cycles above the load shedding cycle budget.",
+                 load_shedder.overrun_count());
+
+  writer.header("shed_stages_total", "counter",
+                "Cycles in which an optional stage was shed.");
+  for (std::size_t i = 0; i < NR_SHED_STAGES; ++i) {
+    writer.sample(
+        "shed_stages_total",
+        std::string("stage=\"") + shed_stage_name(i) + "\"",
+        load_shedder.shed_count(static_cast<ShedStage>(i)));
+  }
+
+  writer.header("dropped_publishes_total", "counter",
+                "Messages not published because the realtime publisher was "
+                "busy.");
+  for (std::size_t i = 0; i < NR_METRICS_PUBLISHERS; ++i) {
+    writer.sample("dropped_publishes_total",
+                  std::string("publisher=\"") + publisher_name(i) + "\"",
+                  dropped_publishes(static_cast<MetricsPublisher>(i)));
+  }
+
+  writer.counter("reference_timeouts_total",
+                 "Topic references dropped after timing out.",
+                 reference_timeouts());
+  writer.counter("invalid_wheel_states_total",
+                 "Cycles skipped by odometry due to NaN wheel states.",
+                 invalid_wheel_states());
+  writer.counter("wheel_stalls_total",
+                 "Detected wheel stalls (commanded wheel not moving).",
+                 fault_monitor.stall_count());
+  writer.counter("faults_total", "Transitions into FAULT.",
+                 fault_monitor.fault_count());
+
+  writer.header("mode", "gauge", "Current controller mode, 1 for the active.");
+  const auto mode = fault_monitor.mode();
+  for (const auto candidate :
+       {ControllerMode::RUNNING, ControllerMode::DEGRADED,
+        ControllerMode::FAULT, ControllerMode::RECOVERING}) {
+    writer.sample("mode",
+                  std::string("mode=\"") + FaultMonitor::to_string(candidate) +
+                      "\"",
+                  std::uint64_t(candidate == mode ? 1 : 0));
+  }
+
+  return std::move(writer.text());
+}
+
+} // namespace mecanum_drive_controller
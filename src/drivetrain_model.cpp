@@ -0,0 +1,102 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/drivetrain_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mecanum_drive_controller {
+constexpr std::size_t DrivetrainModel::MAX_DELAYED_COMMANDS;
+
+DrivetrainModel::DrivetrainModel() { reset(); }
+
+void DrivetrainModel::configure(const DrivetrainModelParams &params) {
+  params_ = params;
+  reset();
+}
+
+void DrivetrainModel::reset() {
+  time_ = 0.0;
+  delay_head_ = 0;
+  delay_size_ = 0;
+  active_commands_.fill(0.0);
+  positions_.fill(0.0);
+  velocities_.fill(0.0);
+  encoder_positions_.fill(0.0);
+  encoder_velocities_.fill(0.0);
+  pose_ = Pose2D();
+}
+
+void DrivetrainModel::set_commands(const WheelVelocities &commands) {
+  if (delay_size_ == MAX_DELAYED_COMMANDS) {
+    // drop the oldest command, the delay gets shorter
+    delay_head_ = (delay_head_ + 1) % MAX_DELAYED_COMMANDS;
+    --delay_size_;
+  }
+  auto &entry =
+      delayed_commands_[(delay_head_ + delay_size_) % MAX_DELAYED_COMMANDS];
+  entry.time = time_;
+  entry.commands = commands;
+  ++delay_size_;
+}
+
+void DrivetrainModel::step(const double dt) {
+  if (dt <= 0.0) {
+    return;
+  }
+
+  // commands become active once they are `command_delay` old
+  while (delay_size_ > 0 && delayed_commands_[delay_head_].time <=
+                                time_ - params_.command_delay) {
+    active_commands_ = delayed_commands_[delay_head_].commands;
+    delay_head_ = (delay_head_ + 1) % MAX_DELAYED_COMMANDS;
+    --delay_size_;
+  }
+
+  // exact discretization of the first-order response
+  const double alpha = params_.time_constant > 0.0
+                           ? 1.0 - std::exp(-dt / params_.time_constant)
+                           : 1.0;
+  const double tick = params_.encoder_resolution > 0.0
+                          ? 2.0 * M_PI / params_.encoder_resolution
+                          : 0.0;
+
+  WheelVelocities ground_velocities;
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    double command =
+        std::isnan(active_commands_[i]) ? 0.0 : active_commands_[i];
+    if (params_.max_velocity > 0.0) {
+      command =
+          std::clamp(command, -params_.max_velocity, params_.max_velocity);
+    }
+    const double previous_velocity = velocities_[i];
+    velocities_[i] += alpha * (command - velocities_[i]);
+    const double mean_velocity = 0.5 * (previous_velocity + velocities_[i]);
+    positions_[i] += mean_velocity * dt;
+
+    const double encoder_position =
+        tick > 0.0 ? std::floor(positions_[i] / tick) * tick : positions_[i];
+    encoder_velocities_[i] = (encoder_position - encoder_positions_[i]) / dt;
+    encoder_positions_[i] = encoder_position;
+
+    ground_velocities[i] = (1.0 - params_.slip_ratio[i]) * mean_velocity;
+  }
+
+  integrate_pose(pose_,
+                 forward_kinematics(params_.kinematics, ground_velocities), dt);
+  time_ += dt;
+}
+
+} // namespace mecanum_drive_controller
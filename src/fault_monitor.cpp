@@ -0,0 +1,115 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/fault_monitor.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mecanum_drive_controller {
+FaultMonitor::FaultMonitor()
+    : auto_recovery_(true), recovery_cycles_(1), stall_command_threshold_(0.0),
+      stall_velocity_threshold_(0.0), stall_cycles_(1), fault_free_cycles_(0),
+      mode_(ControllerMode::RUNNING), reset_requested_(false),
+      fault_count_(0), stall_count_(0) {
+  stalled_cycles_.fill(0);
+}
+
+void FaultMonitor::configure(const bool auto_recovery,
+                             const std::size_t recovery_cycles,
+                             const double stall_command_threshold,
+                             const double stall_velocity_threshold,
+                             const std::size_t stall_cycles) {
+  auto_recovery_ = auto_recovery;
+  recovery_cycles_ = std::max<std::size_t>(recovery_cycles, 1);
+  stall_command_threshold_ = stall_command_threshold;
+  stall_velocity_threshold_ = stall_velocity_threshold;
+  stall_cycles_ = std::max<std::size_t>(stall_cycles, 1);
+  reset();
+}
+
+void FaultMonitor::reset() {
+  stalled_cycles_.fill(0);
+  fault_free_cycles_ = 0;
+  reset_requested_.store(false);
+  mode_.store(ControllerMode::RUNNING, std::memory_order_relaxed);
+}
+
+bool FaultMonitor::check_stall(const std::size_t wheel, const double command,
+                               const double state) {
+  if (stall_command_threshold_ <= 0.0 || wheel >= MAX_WHEELS) {
+    return false;
+  }
+  if (std::abs(command) > stall_command_threshold_ &&
+      !(std::abs(state) > stall_velocity_threshold_)) {
+    if (++stalled_cycles_[wheel] == stall_cycles_) {
+      stall_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+  } else {
+    stalled_cycles_[wheel] = 0;
+  }
+  return stalled_cycles_[wheel] >= stall_cycles_;
+}
+
+ControllerMode FaultMonitor::update(const FaultConditions &conditions) {
+  const bool fault =
+      conditions.wheel_states_invalid || conditions.wheel_stalled;
+  const bool degraded = conditions.reference_stale || conditions.cycle_late;
+  const ControllerMode mode = mode_.load(std::memory_order_relaxed);
+
+  ControllerMode next = mode;
+  if (fault) {
+    if (mode != ControllerMode::FAULT) {
+      fault_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    fault_free_cycles_ = 0;
+    next = ControllerMode::FAULT;
+  } else if (mode == ControllerMode::FAULT) {
+    ++fault_free_cycles_;
+    if (reset_requested_.exchange(false) ||
+        (auto_recovery_ && fault_free_cycles_ >= recovery_cycles_)) {
+      next = ControllerMode::RECOVERING;
+    }
+  } else if (mode == ControllerMode::RECOVERING) {
+    // the stop cycle is over, wheels have to prove again that they move
+    stalled_cycles_.fill(0);
+    fault_free_cycles_ = 0;
+    next = degraded ? ControllerMode::DEGRADED : ControllerMode::RUNNING;
+  } else {
+    next = degraded ? ControllerMode::DEGRADED : ControllerMode::RUNNING;
+  }
+  // a reset only applies to the fault it was requested in
+  if (next != ControllerMode::FAULT) {
+    reset_requested_.store(false);
+  }
+
+  mode_.store(next, std::memory_order_relaxed);
+  return next;
+}
+
+const char *FaultMonitor::to_string(const ControllerMode mode) {
+  switch (mode) {
+  case ControllerMode::RUNNING:
+    return "RUNNING";
+  case ControllerMode::DEGRADED:
+    return "DEGRADED";
+  case ControllerMode::FAULT:
+    return "FAULT";
+  case ControllerMode::RECOVERING:
+    return "RECOVERING";
+  }
+  return "UNKNOWN";
+}
+
+} // namespace mecanum_drive_controller
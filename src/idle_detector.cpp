@@ -0,0 +1,80 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mecanum_drive_controller/idle_detector.hpp"
+
+#include <cmath>
+
+namespace mecanum_drive_controller {
+IdleDetector::IdleDetector()
+    : idle_cycles_(0), velocity_threshold_(0.0), heartbeat_period_(0),
+      inactive_cycles_(0), idle_(false), heartbeat_(false),
+      since_heartbeat_(0), idle_cycle_count_(0) {}
+
+void IdleDetector::configure(const std::size_t idle_cycles,
+                             const double velocity_threshold,
+                             const std::chrono::nanoseconds &heartbeat_period) {
+  idle_cycles_ = idle_cycles;
+  velocity_threshold_ = velocity_threshold;
+  heartbeat_period_ = heartbeat_period;
+  reset();
+}
+
+void IdleDetector::reset() {
+  inactive_cycles_ = 0;
+  idle_ = false;
+  heartbeat_ = false;
+  since_heartbeat_ = std::chrono::nanoseconds(0);
+}
+
+bool IdleDetector::update(const bool reference_active,
+                          const double *wheel_velocities,
+                          const std::size_t nr_wheels,
+                          const std::chrono::nanoseconds &period) {
+  if (!enabled()) {
+    return false;
+  }
+
+  bool active = reference_active;
+  for (std::size_t i = 0; i < nr_wheels && !active; ++i) {
+    // `!(<=)` so that NaN counts as motion
+    active = !(std::abs(wheel_velocities[i]) <= velocity_threshold_);
+  }
+
+  if (active) {
+    reset();
+    return false;
+  }
+
+  if (!idle_) {
+    // the outputs of the cycles so far were published as usual
+    idle_ = ++inactive_cycles_ > idle_cycles_;
+    since_heartbeat_ = std::chrono::nanoseconds(0);
+    heartbeat_ = false;
+  } else {
+    since_heartbeat_ += period;
+    heartbeat_ = since_heartbeat_ >= heartbeat_period_;
+    if (heartbeat_) {
+      since_heartbeat_ = std::chrono::nanoseconds(0);
+    }
+  }
+
+  if (idle_) {
+    idle_cycle_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return idle_;
+}
+
+} // namespace mecanum_drive_controller
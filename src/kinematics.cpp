@@ -0,0 +1,253 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/kinematics.hpp"
+
+#include <cmath>
+
+namespace mecanum_drive_controller {
+WheelVelocities inverse_kinematics(const MecanumKinematicsParams &params,
+                                   const BodyTwist &twist) {
+  /// \note The input twist is a body twist of the base frame. It is rotated
+  /// into the center frame and the offset of the base frame adds the linear
+  /// velocity caused by the rotation.
+  const double cos_theta = std::cos(params.base_frame_offset[2]);
+  const double sin_theta = std::sin(params.base_frame_offset[2]);
+
+  const double velocity_in_center_frame_linear_x =
+      cos_theta * twist.linear_x - sin_theta * twist.linear_y +
+      params.base_frame_offset[1] * twist.angular_z;
+  const double velocity_in_center_frame_linear_y =
+      sin_theta * twist.linear_x + cos_theta * twist.linear_y -
+      params.base_frame_offset[0] * twist.angular_z;
+  const double rotation = params.sum_of_robot_center_projection_on_X_Y_axis *
+                          twist.angular_z;
+
+  const double inverse_radius = 1.0 / params.wheels_radius;
+  return {inverse_radius * (velocity_in_center_frame_linear_x -
+                            velocity_in_center_frame_linear_y - rotation),
+          inverse_radius * (velocity_in_center_frame_linear_x +
+                            velocity_in_center_frame_linear_y + rotation),
+          inverse_radius * (velocity_in_center_frame_linear_x -
+                            velocity_in_center_frame_linear_y + rotation),
+          inverse_radius * (velocity_in_center_frame_linear_x +
+                            velocity_in_center_frame_linear_y - rotation)};
+}
+
+BodyTwist twist_about_point(const BodyTwist &twist, const double x,
+                            const double y) {
+  // v_base = v_point + w x (p_base - p_point)
+  return {twist.linear_x + twist.angular_z * y,
+          twist.linear_y - twist.angular_z * x, twist.angular_z};
+}
+
+BodyTwist forward_kinematics(const MecanumKinematicsParams &params,
+                             const WheelVelocities &wheel_velocities) {
+  const double front_left = wheel_velocities[0];
+  const double front_right = wheel_velocities[1];
+  const double rear_right = wheel_velocities[2];
+  const double rear_left = wheel_velocities[3];
+
+  /// The mecanum FK gives the body twist at the center frame, it is then
+  /// transformed to the base frame.
+  const double velocity_in_center_frame_linear_x =
+      0.25 * params.wheels_radius *
+      (front_left + rear_left + rear_right + front_right);
+  const double velocity_in_center_frame_linear_y =
+      0.25 * params.wheels_radius *
+      (-front_left + rear_left - rear_right + front_right);
+  const double velocity_in_center_frame_angular_z =
+      0.25 * params.wheels_radius /
+      params.sum_of_robot_center_projection_on_X_Y_axis *
+      (-front_left - rear_left + rear_right + front_right);
+
+  // rotation from the center to the base frame
+  const double cos_theta = std::cos(-params.base_frame_offset[2]);
+  const double sin_theta = std::sin(-params.base_frame_offset[2]);
+  // offset of the center wrt the base frame
+  const double offset_x = -cos_theta * params.base_frame_offset[0] +
+                          sin_theta * params.base_frame_offset[1];
+  const double offset_y = -sin_theta * params.base_frame_offset[0] -
+                          cos_theta * params.base_frame_offset[1];
+
+  BodyTwist twist;
+  twist.linear_x = cos_theta * velocity_in_center_frame_linear_x -
+                   sin_theta * velocity_in_center_frame_linear_y +
+                   offset_y * velocity_in_center_frame_angular_z;
+  twist.linear_y = sin_theta * velocity_in_center_frame_linear_x +
+                   cos_theta * velocity_in_center_frame_linear_y -
+                   offset_x * velocity_in_center_frame_angular_z;
+  twist.angular_z = velocity_in_center_frame_angular_z;
+  return twist;
+}
+
+Pose2D compose_poses(const Pose2D &a, const Pose2D &b) {
+  const double cos_rz = std::cos(a.rz);
+  const double sin_rz = std::sin(a.rz);
+  return {a.x + cos_rz * b.x - sin_rz * b.y, a.y + sin_rz * b.x + cos_rz * b.y,
+          a.rz + b.rz};
+}
+
+void integrate_pose(Pose2D &pose, const BodyTwist &twist, const double dt) {
+  /// NOTE: the position is expressed in the odometry frame, unlike the twist
+  /// which is expressed in the body frame.
+  const double cos_rz = std::cos(pose.rz);
+  const double sin_rz = std::sin(pose.rz);
+  pose.rz += twist.angular_z * dt;
+  pose.x += (cos_rz * twist.linear_x - sin_rz * twist.linear_y) * dt;
+  pose.y += (sin_rz * twist.linear_x + cos_rz * twist.linear_y) * dt;
+}
+
+bool CoupledKinematics::configure(
+    const std::array<MecanumKinematicsParams, NR_COUPLED_BASES> &params,
+    const std::array<Pose2D, NR_COUPLED_BASES> &base_poses) {
+  // the IK is linear, so the columns of J are the IK of the unit twists
+  for (std::size_t k = 0; k < 3; ++k) {
+    const BodyTwist unit_twist{k == 0 ? 1.0 : 0.0, k == 1 ? 1.0 : 0.0,
+                               k == 2 ? 1.0 : 0.0};
+    for (std::size_t base = 0; base < NR_COUPLED_BASES; ++base) {
+      const auto &pose = base_poses[base];
+      // velocity of the base frame origin, rotated into the base frame
+      const double velocity_x =
+          unit_twist.linear_x - unit_twist.angular_z * pose.y;
+      const double velocity_y =
+          unit_twist.linear_y + unit_twist.angular_z * pose.x;
+      const double cos_rz = std::cos(pose.rz);
+      const double sin_rz = std::sin(pose.rz);
+      const auto wheels = inverse_kinematics(
+          params[base], {cos_rz * velocity_x + sin_rz * velocity_y,
+                         -sin_rz * velocity_x + cos_rz * velocity_y,
+                         unit_twist.angular_z});
+      for (std::size_t j = 0; j < NR_WHEELS; ++j) {
+        jacobian_[NR_WHEELS * base + j][k] = wheels[j];
+      }
+    }
+  }
+
+  // normal matrix J^T J and its inverse through the adjugate
+  double normal[3][3] = {};
+  for (const auto &row : jacobian_) {
+    for (std::size_t r = 0; r < 3; ++r) {
+      for (std::size_t c = 0; c < 3; ++c) {
+        normal[r][c] += row[r] * row[c];
+      }
+    }
+  }
+  const double adjugate[3][3] = {
+      {normal[1][1] * normal[2][2] - normal[1][2] * normal[2][1],
+       normal[0][2] * normal[2][1] - normal[0][1] * normal[2][2],
+       normal[0][1] * normal[1][2] - normal[0][2] * normal[1][1]},
+      {normal[1][2] * normal[2][0] - normal[1][0] * normal[2][2],
+       normal[0][0] * normal[2][2] - normal[0][2] * normal[2][0],
+       normal[0][2] * normal[1][0] - normal[0][0] * normal[1][2]},
+      {normal[1][0] * normal[2][1] - normal[1][1] * normal[2][0],
+       normal[0][1] * normal[2][0] - normal[0][0] * normal[2][1],
+       normal[0][0] * normal[1][1] - normal[0][1] * normal[1][0]}};
+  const double determinant = normal[0][0] * adjugate[0][0] +
+                             normal[0][1] * adjugate[1][0] +
+                             normal[0][2] * adjugate[2][0];
+  const double trace = normal[0][0] + normal[1][1] + normal[2][2];
+  if (!std::isfinite(determinant) ||
+      std::abs(determinant) <= 1e-12 * trace * trace * trace) {
+    return false;
+  }
+
+  for (std::size_t r = 0; r < 3; ++r) {
+    for (std::size_t i = 0; i < NR_COUPLED_WHEELS; ++i) {
+      double value = 0.0;
+      for (std::size_t c = 0; c < 3; ++c) {
+        value += adjugate[r][c] * jacobian_[i][c];
+      }
+      pseudo_inverse_[r][i] = value / determinant;
+    }
+  }
+  return true;
+}
+
+CoupledWheelVelocities
+CoupledKinematics::inverse(const BodyTwist &twist) const {
+  CoupledWheelVelocities wheel_velocities;
+  for (std::size_t i = 0; i < NR_COUPLED_WHEELS; ++i) {
+    wheel_velocities[i] = jacobian_[i][0] * twist.linear_x +
+                          jacobian_[i][1] * twist.linear_y +
+                          jacobian_[i][2] * twist.angular_z;
+  }
+  return wheel_velocities;
+}
+
+BodyTwist CoupledKinematics::forward(
+    const CoupledWheelVelocities &wheel_velocities) const {
+  double twist[3] = {};
+  for (std::size_t r = 0; r < 3; ++r) {
+    for (std::size_t i = 0; i < NR_COUPLED_WHEELS; ++i) {
+      twist[r] += pseudo_inverse_[r][i] * wheel_velocities[i];
+    }
+  }
+  return {twist[0], twist[1], twist[2]};
+}
+
+void inverse_kinematics_batch(const MecanumKinematicsParams &params,
+                              const double *twists, const std::size_t count,
+                              double *wheel_velocities) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const double *twist = twists + 3 * i;
+    const auto wheels =
+        inverse_kinematics(params, {twist[0], twist[1], twist[2]});
+    for (std::size_t j = 0; j < NR_WHEELS; ++j) {
+      wheel_velocities[NR_WHEELS * i + j] = wheels[j];
+    }
+  }
+}
+
+void forward_kinematics_batch(const MecanumKinematicsParams &params,
+                              const double *wheel_velocities,
+                              const std::size_t count, double *twists) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const double *wheels = wheel_velocities + NR_WHEELS * i;
+    const auto twist = forward_kinematics(
+        params, {wheels[0], wheels[1], wheels[2], wheels[3]});
+    twists[3 * i] = twist.linear_x;
+    twists[3 * i + 1] = twist.linear_y;
+    twists[3 * i + 2] = twist.angular_z;
+  }
+}
+
+void integrate_odometry_batch(const MecanumKinematicsParams &params,
+                              Pose2D &pose, const double *wheel_velocities,
+                              const double *dts, const std::size_t count,
+                              double *poses, double *twists) {
+  BodyTwist twist;
+  for (std::size_t i = 0; i < count; ++i) {
+    const double *wheels = wheel_velocities + NR_WHEELS * i;
+    // the controller keeps the last twist when a wheel state is invalid
+    if (!std::isnan(wheels[0]) && !std::isnan(wheels[1]) &&
+        !std::isnan(wheels[2]) && !std::isnan(wheels[3])) {
+      twist = forward_kinematics(params,
+                                 {wheels[0], wheels[1], wheels[2], wheels[3]});
+      integrate_pose(pose, twist, dts[i]);
+    }
+    if (poses) {
+      poses[3 * i] = pose.x;
+      poses[3 * i + 1] = pose.y;
+      poses[3 * i + 2] = pose.rz;
+    }
+    if (twists) {
+      twists[3 * i] = twist.linear_x;
+      twists[3 * i + 1] = twist.linear_y;
+      twists[3 * i + 2] = twist.angular_z;
+    }
+  }
+}
+
+} // namespace mecanum_drive_controller
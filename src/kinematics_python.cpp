@@ -0,0 +1,162 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Python bindings of the kinematics used by the controller, for offline
+// analysis of logs with the production math:
+//
+//   import numpy as np
+//   import mecanum_kinematics as mk
+//   params = mk.KinematicsParams(0.05, 0.5)
+//   twists = mk.forward_kinematics(params, wheel_velocities)  # (N, 4)
+//   poses, twists = mk.integrate_odometry(params, wheel_velocities, dts)
+//
+// C-contiguous float64 arrays are used without copying, other arrays are
+// converted once. The GIL is released during the batch loops, so several
+// logs can be processed in parallel from Python threads.
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#include "mecanum_drive_controller/kinematics.hpp"
+
+namespace py = pybind11;
+using mecanum_drive_controller::MecanumKinematicsParams;
+using mecanum_drive_controller::NR_WHEELS;
+
+namespace { // utility
+
+using InputArray =
+    py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+// \return number of rows of a `rows` x `columns` array
+std::size_t check_shape(const InputArray &array, const std::size_t columns,
+                        const char *name) {
+  if (array.ndim() != 2 ||
+      static_cast<std::size_t>(array.shape(1)) != columns) {
+    throw std::invalid_argument(std::string(name) + " must have shape (N, " +
+                                std::to_string(columns) + ")");
+  }
+  return static_cast<std::size_t>(array.shape(0));
+}
+
+py::array_t<double> make_output(const std::size_t rows,
+                                const std::size_t columns) {
+  return py::array_t<double>(
+      {static_cast<py::ssize_t>(rows), static_cast<py::ssize_t>(columns)});
+}
+
+py::array_t<double> inverse_kinematics(const MecanumKinematicsParams &params,
+                                       const InputArray &twists) {
+  const std::size_t count = check_shape(twists, 3, "twists");
+  auto wheel_velocities = make_output(count, NR_WHEELS);
+  const double *input = twists.data();
+  double *output = wheel_velocities.mutable_data();
+  {
+    py::gil_scoped_release release;
+    mecanum_drive_controller::inverse_kinematics_batch(params, input, count,
+                                                       output);
+  }
+  return wheel_velocities;
+}
+
+py::array_t<double> forward_kinematics(const MecanumKinematicsParams &params,
+                                       const InputArray &wheel_velocities) {
+  const std::size_t count =
+      check_shape(wheel_velocities, NR_WHEELS, "wheel_velocities");
+  auto twists = make_output(count, 3);
+  const double *input = wheel_velocities.data();
+  double *output = twists.mutable_data();
+  {
+    py::gil_scoped_release release;
+    mecanum_drive_controller::forward_kinematics_batch(params, input, count,
+                                                       output);
+  }
+  return twists;
+}
+
+std::tuple<py::array_t<double>, py::array_t<double>>
+integrate_odometry(const MecanumKinematicsParams &params,
+                   const InputArray &wheel_velocities, const InputArray &dts,
+                   const std::array<double, 3> &initial_pose) {
+  const std::size_t count =
+      check_shape(wheel_velocities, NR_WHEELS, "wheel_velocities");
+  if (dts.ndim() != 1 || static_cast<std::size_t>(dts.shape(0)) != count) {
+    throw std::invalid_argument("dts must have shape (N,)");
+  }
+  auto poses = make_output(count, 3);
+  auto twists = make_output(count, 3);
+  const double *wheels = wheel_velocities.data();
+  const double *steps = dts.data();
+  double *poses_output = poses.mutable_data();
+  double *twists_output = twists.mutable_data();
+  {
+    py::gil_scoped_release release;
+    mecanum_drive_controller::Pose2D pose;
+    pose.x = initial_pose[0];
+    pose.y = initial_pose[1];
+    pose.rz = initial_pose[2];
+    mecanum_drive_controller::integrate_odometry_batch(
+        params, pose, wheels, steps, count, poses_output, twists_output);
+  }
+  return std::make_tuple(poses, twists);
+}
+
+} // namespace
+
+PYBIND11_MODULE(mecanum_kinematics, m) {
+  m.doc() = "Kinematics and odometry of mecanum_drive_controller. Wheels are "
+            "sorted front left, front right, rear right, rear left.";
+
+  py::class_<MecanumKinematicsParams>(m, "KinematicsParams")
+      .def(py::init([](const double wheels_radius,
+                       const double sum_of_robot_center_projection_on_X_Y_axis,
+                       const std::array<double, 3> &base_frame_offset) {
+             MecanumKinematicsParams params;
+             params.wheels_radius = wheels_radius;
+             params.sum_of_robot_center_projection_on_X_Y_axis =
+                 sum_of_robot_center_projection_on_X_Y_axis;
+             params.base_frame_offset = base_frame_offset;
+             return params;
+           }),
+           py::arg("wheels_radius"),
+           py::arg("sum_of_robot_center_projection_on_X_Y_axis"),
+           py::arg("base_frame_offset") = std::array<double, 3>{0.0, 0.0, 0.0})
+      .def_readwrite("wheels_radius", &MecanumKinematicsParams::wheels_radius)
+      .def_readwrite("sum_of_robot_center_projection_on_X_Y_axis",
+                     &MecanumKinematicsParams::
+                         sum_of_robot_center_projection_on_X_Y_axis)
+      .def_readwrite("base_frame_offset",
+                     &MecanumKinematicsParams::base_frame_offset);
+
+  m.def("inverse_kinematics", &inverse_kinematics, py::arg("params"),
+        py::arg("twists"),
+        "Wheel velocities (N, 4) [rad/s] of body twists (N, 3) "
+        "[linear_x, linear_y, angular_z] of the base frame.");
+  m.def("forward_kinematics", &forward_kinematics, py::arg("params"),
+        py::arg("wheel_velocities"),
+        "Body twists (N, 3) of the base frame of wheel velocities (N, 4).");
+  m.def("integrate_odometry", &integrate_odometry, py::arg("params"),
+        py::arg("wheel_velocities"), py::arg("dts"),
+        py::arg("initial_pose") = std::array<double, 3>{0.0, 0.0, 0.0},
+        "Steps the controller odometry through wheel velocities (N, 4) with "
+        "time steps dts (N,) [s]. Returns the poses (N, 3) [x, y, rz] after "
+        "each step and the body twists (N, 3). Samples with NaN are skipped "
+        "like in the controller.");
+}
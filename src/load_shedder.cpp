@@ -0,0 +1,96 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/load_shedder.hpp"
+
+#include <algorithm>
+
+namespace mecanum_drive_controller {
+LoadShedder::LoadShedder()
+    : cycle_budget_(0), overrun_cycles_(1), recovery_cycles_(1),
+      odometry_decimation_(1), consecutive_overruns_(0),
+      consecutive_in_budget_(0), odometry_cycle_(0), level_(0),
+      overrun_count_(0) {
+  for (auto &count : shed_counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+void LoadShedder::configure(const std::chrono::nanoseconds &cycle_budget,
+                            const std::size_t overrun_cycles,
+                            const std::size_t recovery_cycles,
+                            const std::size_t odometry_decimation) {
+  cycle_budget_ = cycle_budget;
+  overrun_cycles_ = std::max<std::size_t>(overrun_cycles, 1);
+  recovery_cycles_ = std::max<std::size_t>(recovery_cycles, 1);
+  odometry_decimation_ = std::max<std::size_t>(odometry_decimation, 1);
+  reset();
+}
+
+void LoadShedder::reset() {
+  consecutive_overruns_ = 0;
+  consecutive_in_budget_ = 0;
+  odometry_cycle_ = 0;
+  level_.store(0, std::memory_order_relaxed);
+}
+
+void LoadShedder::update(const std::chrono::nanoseconds &cycle_duration) {
+  if (!enabled()) {
+    return;
+  }
+
+  const std::size_t level = level_.load(std::memory_order_relaxed);
+  if (cycle_duration > cycle_budget_) {
+    overrun_count_.fetch_add(1, std::memory_order_relaxed);
+    consecutive_in_budget_ = 0;
+    if (++consecutive_overruns_ >= overrun_cycles_) {
+      consecutive_overruns_ = 0;
+      level_.store(std::min(level + 1, NR_SHED_STAGES),
+                   std::memory_order_relaxed);
+    }
+  } else {
+    consecutive_overruns_ = 0;
+    if (level > 0 && ++consecutive_in_budget_ >= recovery_cycles_) {
+      consecutive_in_budget_ = 0;
+      level_.store(level - 1, std::memory_order_relaxed);
+    }
+  }
+}
+
+bool LoadShedder::should_run(const ShedStage stage) {
+  if (!is_shed(stage)) {
+    return true;
+  }
+  count_shed(stage);
+  return false;
+}
+
+bool LoadShedder::should_publish_odometry() {
+  if (!is_shed(ShedStage::ODOMETRY_DECIMATION)) {
+    odometry_cycle_ = 0;
+    return true;
+  }
+  if (odometry_cycle_++ % odometry_decimation_ == 0) {
+    return true;
+  }
+  count_shed(ShedStage::ODOMETRY_DECIMATION);
+  return false;
+}
+
+void LoadShedder::count_shed(const ShedStage stage) {
+  shed_counts_[static_cast<std::size_t>(stage)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+} // namespace mecanum_drive_controller
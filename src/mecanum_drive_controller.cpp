@@ -1,4 +1,11 @@
 #include "mecanum_drive_controller/mecanum_drive_controller.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <ctime>
+
 #include "hardware_interface/types/hardware_interface_type_values.hpp"
 #include "tf2/LinearMath/Matrix3x3.h"
 #include "tf2/LinearMath/Quaternion.h"
@@ -22,6 +29,12 @@ void reset_controller_reference_msg(
   msg->twist.angular.z = std::numeric_limits<double>::quiet_NaN();
 }
 
+// stamp in integer nanoseconds, without the checks of rclcpp::Time
+std::int64_t to_nanoseconds(const builtin_interfaces::msg::Time &stamp) {
+  return static_cast<std::int64_t>(stamp.sec) * 1000000000 +
+         static_cast<std::int64_t>(stamp.nanosec);
+}
+
 // return True if vl:{x, y} && va:{z} not nan
 bool is_msg_valid(const ControllerReferenceMsg::ConstSharedPtr &msg) {
   return !std::isnan(msg->twist.linear.x) && !std::isnan(msg->twist.linear.y) &&
@@ -57,10 +70,10 @@ MecanumDriveController::command_interface_configuration() const {
   command_interfaces_config.type =
       controller_interface::interface_configuration_type::INDIVIDUAL;
 
-  command_interfaces_config.names.reserve(command_joint_names_.size());
-  for (const auto &joint : command_joint_names_) {
+  command_interfaces_config.names.reserve(nr_joint_names_);
+  for (size_t i = 0; i < nr_joint_names_; ++i) {
     command_interfaces_config.names.push_back(
-        joint + "/" + hardware_interface::HW_IF_VELOCITY);
+        command_joint_names_[i] + "/" + hardware_interface::HW_IF_VELOCITY);
   }
 
   return command_interfaces_config;
@@ -72,11 +85,20 @@ MecanumDriveController::state_interface_configuration() const {
   state_interfaces_config.type =
       controller_interface::interface_configuration_type::INDIVIDUAL;
 
-  state_interfaces_config.names.reserve(state_joint_names_.size());
+  state_interfaces_config.names.reserve(nr_joint_names_ + 1);
 
-  for (const auto &joint : state_joint_names_) {
-    state_interfaces_config.names.push_back(joint + "/" +
-                                            hardware_interface::HW_IF_VELOCITY);
+  // velocities are estimated from positions if enabled
+  const auto interface_name = params_.velocity_estimation.enable
+                                  ? hardware_interface::HW_IF_POSITION
+                                  : hardware_interface::HW_IF_VELOCITY;
+  for (size_t i = 0; i < nr_joint_names_; ++i) {
+    state_interfaces_config.names.push_back(state_joint_names_[i] + "/" +
+                                            interface_name);
+  }
+  // the measured yaw rate follows the wheels
+  if (yaw_rate_from_imu_) {
+    state_interfaces_config.names.push_back(
+        params_.yaw_rate_feedback.imu_interface);
   }
 
   return state_interfaces_config;
@@ -99,8 +121,9 @@ controller_interface::CallbackReturn MecanumDriveController::on_configure(
         }
       };
 
-  command_joint_names_.resize(4);
-  state_joint_names_.resize(4);
+  nr_joint_names_ = params_.coupled.enable ? NR_COUPLED_WHEELS : NR_WHEELS;
+  command_joint_names_.fill(std::string());
+  state_joint_names_.fill(std::string());
 
   // The joint names are sorted according to the order documented in the header
   // file!
@@ -116,11 +139,111 @@ controller_interface::CallbackReturn MecanumDriveController::on_configure(
   prepare_lists_with_joint_names(REAR_LEFT,
                                  params_.rear_left_wheel_command_joint_name,
                                  params_.rear_left_wheel_state_joint_name);
+  if (params_.coupled.enable) {
+    const auto &coupled = params_.coupled;
+    if (coupled.front_left_wheel_command_joint_name.empty() ||
+        coupled.front_right_wheel_command_joint_name.empty() ||
+        coupled.rear_right_wheel_command_joint_name.empty() ||
+        coupled.rear_left_wheel_command_joint_name.empty()) {
+      RCLCPP_ERROR(get_node()->get_logger(),
+                   "Coupled mode needs the command joint names of all wheels "
+                   "of the second base.");
+      return controller_interface::CallbackReturn::ERROR;
+    }
+    prepare_lists_with_joint_names(NR_WHEELS + FRONT_LEFT,
+                                   coupled.front_left_wheel_command_joint_name,
+                                   coupled.front_left_wheel_state_joint_name);
+    prepare_lists_with_joint_names(
+        NR_WHEELS + FRONT_RIGHT, coupled.front_right_wheel_command_joint_name,
+        coupled.front_right_wheel_state_joint_name);
+    prepare_lists_with_joint_names(NR_WHEELS + REAR_RIGHT,
+                                   coupled.rear_right_wheel_command_joint_name,
+                                   coupled.rear_right_wheel_state_joint_name);
+    prepare_lists_with_joint_names(NR_WHEELS + REAR_LEFT,
+                                   coupled.rear_left_wheel_command_joint_name,
+                                   coupled.rear_left_wheel_state_joint_name);
+  }
 
   // Set wheel params for the odometry computation
   odometry_.setWheelsParams(
       params_.kinematics.sum_of_robot_center_projection_on_X_Y_axis,
       params_.kinematics.wheels_radius);
+  kinematics_params_.wheels_radius = params_.kinematics.wheels_radius;
+  kinematics_params_.sum_of_robot_center_projection_on_X_Y_axis =
+      params_.kinematics.sum_of_robot_center_projection_on_X_Y_axis;
+  kinematics_params_.base_frame_offset = {
+      params_.kinematics.base_frame_offset.x,
+      params_.kinematics.base_frame_offset.y,
+      params_.kinematics.base_frame_offset.theta};
+  // both bases share the geometry, the carrier frame is the first base frame
+  if (params_.coupled.enable &&
+      !coupled_kinematics_.configure(
+          {kinematics_params_, kinematics_params_},
+          {Pose2D(),
+           Pose2D{params_.coupled.base_offset.x, params_.coupled.base_offset.y,
+                  params_.coupled.base_offset.theta}})) {
+    RCLCPP_ERROR(get_node()->get_logger(),
+                 "The wheels of the coupled bases do not observe the full "
+                 "twist, check the kinematics parameters.");
+    return controller_interface::CallbackReturn::ERROR;
+  }
+  std::array<double, 6> pose_covariance_diagonal;
+  std::array<double, 6> twist_covariance_diagonal;
+  std::copy_n(params_.pose_covariance_diagonal.begin(), 6,
+              pose_covariance_diagonal.begin());
+  std::copy_n(params_.twist_covariance_diagonal.begin(), 6,
+              twist_covariance_diagonal.begin());
+  odometry_.setCovarianceDiagonals(pose_covariance_diagonal,
+                                   twist_covariance_diagonal);
+  odometry_.init(get_node()->now(),
+                 {params_.kinematics.base_frame_offset.x,
+                  params_.kinematics.base_frame_offset.y,
+                  params_.kinematics.base_frame_offset.theta});
+
+  velocity_estimator_.configure(
+      static_cast<std::size_t>(params_.velocity_estimation.min_window),
+      static_cast<std::size_t>(params_.velocity_estimation.max_window),
+      params_.velocity_estimation.min_displacement);
+
+  load_shedder_.configure(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::duration<double>(params_.load_shedding.cycle_budget)),
+      static_cast<std::size_t>(params_.load_shedding.overrun_cycles),
+      static_cast<std::size_t>(params_.load_shedding.recovery_cycles),
+      static_cast<std::size_t>(params_.load_shedding.odometry_decimation));
+
+  idle_detector_.configure(
+      static_cast<std::size_t>(params_.idle.cycles),
+      params_.idle.velocity_threshold,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::duration<double>(params_.idle.heartbeat_period)));
+
+  yaw_rate_from_imu_ = params_.yaw_rate_feedback.enable &&
+                       params_.yaw_rate_feedback.source == "imu";
+  if (yaw_rate_from_imu_ && params_.yaw_rate_feedback.imu_interface.empty()) {
+    RCLCPP_ERROR(get_node()->get_logger(),
+                 "Yaw rate feedback from an IMU needs 'imu_interface'.");
+    return controller_interface::CallbackReturn::ERROR;
+  }
+  yaw_rate_controller_.configure(params_.yaw_rate_feedback.kp,
+                                 params_.yaw_rate_feedback.ki,
+                                 params_.yaw_rate_feedback.max_correction);
+
+  ReferencePipelineParams pipeline_params;
+  const auto &pipeline = params_.reference_pipeline;
+  std::copy(pipeline.scale.begin(), pipeline.scale.end(),
+            pipeline_params.scale.begin());
+  std::copy(pipeline.limit.begin(), pipeline.limit.end(),
+            pipeline_params.limit.begin());
+  std::copy(pipeline.deadband.begin(), pipeline.deadband.end(),
+            pipeline_params.deadband.begin());
+  pipeline_params.frame = {pipeline.frame.x, pipeline.frame.y,
+                           pipeline.frame.theta};
+  if (!reference_pipeline_.configure(pipeline.stages, pipeline_params)) {
+    RCLCPP_ERROR(get_node()->get_logger(), "Invalid reference pipeline: %s",
+                 reference_pipeline_.error().c_str());
+    return controller_interface::CallbackReturn::ERROR;
+  }
 
   // topics QoS
   auto subscribers_qos = rclcpp::SystemDefaultsQoS();
@@ -128,12 +251,110 @@ controller_interface::CallbackReturn MecanumDriveController::on_configure(
   subscribers_qos.best_effort();
 
   // Reference Subscriber
-  ref_timeout_ = rclcpp::Duration::from_seconds(params_.reference_timeout);
+  ref_timeout_nanoseconds_ =
+      rclcpp::Duration::from_seconds(params_.reference_timeout).nanoseconds();
   ref_subscriber_ = get_node()->create_subscription<ControllerReferenceMsg>(
       "~/reference", subscribers_qos,
       std::bind(&MecanumDriveController::reference_callback, this,
                 std::placeholders::_1));
 
+  // Obstacle distances subscriber
+  obstacle_timeout_nanoseconds_ =
+      rclcpp::Duration::from_seconds(params_.obstacle_speed_limit.timeout)
+          .nanoseconds();
+  obstacle_distances_.store(ObstacleDistances());
+  last_obstacle_distances_ = ObstacleDistances();
+  obstacle_distances_subscriber_.reset();
+  if (params_.obstacle_speed_limit.enable) {
+    obstacle_distances_subscriber_ =
+        get_node()->create_subscription<ObstacleDistancesMsg>(
+            "~/obstacle_distances", subscribers_qos,
+            std::bind(&MecanumDriveController::obstacle_distances_callback,
+                      this, std::placeholders::_1));
+  }
+
+  // Map correction subscriber
+  map_correction_.store(MapCorrection());
+  last_map_correction_ = MapCorrection();
+  map_correction_subscriber_.reset();
+  if (params_.map_pose.enable) {
+    map_correction_subscriber_ =
+        get_node()->create_subscription<MapCorrectionMsg>(
+            "~/map_correction", subscribers_qos,
+            std::bind(&MecanumDriveController::map_correction_callback, this,
+                      std::placeholders::_1));
+  }
+
+  // Reference socket listener
+  ref_socket_listener_.reset();
+  if (!params_.reference_socket.type.empty()) {
+    ref_socket_listener_ = std::make_unique<ReferenceSocketListener>();
+    const auto type = params_.reference_socket.type == "unix"
+                          ? ReferenceSocketListener::Type::UNIX
+                          : ReferenceSocketListener::Type::UDP;
+    if (!ref_socket_listener_->start(
+            type, params_.reference_socket.unix_path,
+            static_cast<std::uint16_t>(params_.reference_socket.udp_port),
+            std::bind(&MecanumDriveController::socket_reference_callback, this,
+                      std::placeholders::_1))) {
+      RCLCPP_ERROR(get_node()->get_logger(),
+                   "Failed to open reference socket: %s",
+                   ref_socket_listener_->error().c_str());
+      return controller_interface::CallbackReturn::ERROR;
+    }
+  }
+
+  // Metrics exporter
+  metrics_exporter_.reset();
+  metrics_.reset();
+  if (!params_.metrics.type.empty()) {
+    metrics_exporter_ = std::make_unique<MetricsExporter>();
+    const auto type = params_.metrics.type == "file"
+                          ? MetricsExporter::Type::FILE
+                          : MetricsExporter::Type::HTTP;
+    const std::string controller_name = get_node()->get_name();
+    if (!metrics_exporter_->start(
+            type, params_.metrics.file_path,
+            static_cast<std::uint16_t>(params_.metrics.http_port),
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::duration<double>(params_.metrics.period)),
+            [this, controller_name]() {
+              return metrics_.render_prometheus(controller_name, load_shedder_,
+                                                fault_monitor_);
+            })) {
+      RCLCPP_ERROR(get_node()->get_logger(), "Failed to export metrics: %s",
+                   metrics_exporter_->error().c_str());
+      return controller_interface::CallbackReturn::ERROR;
+    }
+  }
+
+  // Telemetry archive, one file per configuration
+  telemetry_recorder_.reset();
+  telemetry_cycle_ = 0;
+  if (!params_.telemetry_archive.directory.empty()) {
+    const std::time_t now = std::time(nullptr);
+    std::tm local_time;
+    localtime_r(&now, &local_time);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &local_time);
+    const std::string path = params_.telemetry_archive.directory + "/" +
+                             get_node()->get_name() + "_" + stamp + ".mdta";
+
+    telemetry_recorder_ = std::make_unique<TelemetryRecorder>();
+    if (!telemetry_recorder_->start(
+            path,
+            static_cast<std::size_t>(params_.telemetry_archive.queue_size),
+            static_cast<std::size_t>(
+                params_.telemetry_archive.block_samples))) {
+      RCLCPP_ERROR(get_node()->get_logger(),
+                   "Failed to open telemetry archive: %s",
+                   telemetry_recorder_->error().c_str());
+      return controller_interface::CallbackReturn::ERROR;
+    }
+    RCLCPP_INFO(get_node()->get_logger(), "Recording telemetry to '%s'",
+                path.c_str());
+  }
+
   // send a STOP command(all Nan in msg)
   std::shared_ptr<ControllerReferenceMsg> msg =
       std::make_shared<ControllerReferenceMsg>();
@@ -160,12 +381,13 @@ controller_interface::CallbackReturn MecanumDriveController::on_configure(
   rt_odom_state_publisher_->msg_.child_frame_id = params_.base_frame_id;
   rt_odom_state_publisher_->msg_.pose.pose.position.z = 0;
 
-  auto &covariance = rt_odom_state_publisher_->msg_.twist.covariance;
+  auto &pose_covariance = rt_odom_state_publisher_->msg_.pose.covariance;
+  auto &twist_covariance = rt_odom_state_publisher_->msg_.twist.covariance;
   constexpr size_t NUM_DIMENSIONS = 6;
   for (size_t index = 0; index < 6; ++index) {
     const size_t diagonal_index = NUM_DIMENSIONS * index + index;
-    covariance[diagonal_index] = params_.pose_covariance_diagonal[index];
-    covariance[diagonal_index] = params_.twist_covariance_diagonal[index];
+    pose_covariance[diagonal_index] = pose_covariance_diagonal[index];
+    twist_covariance[diagonal_index] = twist_covariance_diagonal[index];
   }
   rt_odom_state_publisher_->unlock();
 
@@ -188,6 +410,157 @@ controller_interface::CallbackReturn MecanumDriveController::on_configure(
   controller_state_publisher_->msg_.header.frame_id = params_.odom_frame_id;
   controller_state_publisher_->unlock();
 
+
+  map_pose_publisher_.reset();
+  if (params_.map_pose.enable) {
+    try {
+      // map pose publisher
+      map_pose_s_publisher_ = get_node()->create_publisher<MapPoseMsg>(
+          "~/map_pose", rclcpp::SystemDefaultsQoS());
+      map_pose_publisher_ =
+          std::make_unique<MapPosePublisher>(map_pose_s_publisher_);
+    } catch (const std::exception &e) {
+      fprintf(stderr,
+              "Exception thrown during publisher creation at configure stage "
+              "with message : %s \n",
+              e.what());
+      return controller_interface::CallbackReturn::ERROR;
+    }
+
+    map_pose_publisher_->lock();
+    map_pose_publisher_->msg_.header.frame_id = params_.map_pose.frame_id;
+    map_pose_publisher_->msg_.pose.position.z = 0.0;
+    map_pose_publisher_->unlock();
+  }
+  map_pose_cycle_ = 0;
+
+  // the statistics stream and its publisher thread only exist if enabled
+  state_statistics_publisher_.reset();
+  statistics_s_publisher_.reset();
+  if (params_.controller_state_statistics) {
+    try {
+      // controller state statistics publisher
+      statistics_s_publisher_ =
+          get_node()->create_publisher<ControllerStateStatisticsMsg>(
+              "~/controller_state_statistics", rclcpp::SystemDefaultsQoS());
+      state_statistics_publisher_ =
+          std::make_unique<ControllerStateStatisticsPublisher>(
+              statistics_s_publisher_);
+    } catch (const std::exception &e) {
+      fprintf(stderr,
+              "Exception thrown during publisher creation at configure stage "
+              "with message : %s \n",
+              e.what());
+      return controller_interface::CallbackReturn::ERROR;
+    }
+
+    // rows: signals, columns: min, max, mean
+    constexpr size_t NR_STATISTICS = 3;
+    state_statistics_publisher_->lock();
+    auto &layout = state_statistics_publisher_->msg_.layout;
+    layout.dim.resize(2);
+    layout.dim[0].label = "signal";
+    layout.dim[0].size = NR_STATE_STATISTICS_SIGNALS;
+    layout.dim[0].stride = NR_STATE_STATISTICS_SIGNALS * NR_STATISTICS;
+    layout.dim[1].label = "min_max_mean";
+    layout.dim[1].size = NR_STATISTICS;
+    layout.dim[1].stride = NR_STATISTICS;
+    layout.data_offset = 0;
+    state_statistics_publisher_->msg_.data.assign(
+        NR_STATE_STATISTICS_SIGNALS * NR_STATISTICS,
+        std::numeric_limits<double>::quiet_NaN());
+    state_statistics_publisher_->unlock();
+  }
+  state_statistics_.reset();
+  controller_state_cycle_ = 0;
+
+  // Reference age histograms, published from a timer outside the RT loop
+  reference_age_timer_.reset();
+  reference_age_publisher_.reset();
+  if (params_.reference_age_publish_period > 0.0) {
+    try {
+      reference_age_publisher_ =
+          get_node()->create_publisher<ReferenceAgeHistogramMsg>(
+              "~/reference_age_histogram", rclcpp::SystemDefaultsQoS());
+    } catch (const std::exception &e) {
+      fprintf(stderr,
+              "Exception thrown during publisher creation at configure stage "
+              "with message : %s \n",
+              e.what());
+      return controller_interface::CallbackReturn::ERROR;
+    }
+    reference_age_timer_ = get_node()->create_wall_timer(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::duration<double>(
+                params_.reference_age_publish_period)),
+        [this]() {
+          // rows: inputs, columns: buckets
+          ReferenceAgeHistogramMsg msg;
+          msg.layout.dim.resize(2);
+          msg.layout.dim[0].label = "input";
+          msg.layout.dim[0].size = NR_REFERENCE_INPUTS;
+          msg.layout.dim[0].stride =
+              NR_REFERENCE_INPUTS * LatencyHistogram::NR_BUCKETS;
+          msg.layout.dim[1].label = "bucket";
+          msg.layout.dim[1].size = LatencyHistogram::NR_BUCKETS;
+          msg.layout.dim[1].stride = LatencyHistogram::NR_BUCKETS;
+          for (size_t input = 0; input < NR_REFERENCE_INPUTS; ++input) {
+            const auto &histogram = metrics_.reference_ages(
+                static_cast<ReferenceInput>(input));
+            for (size_t i = 0; i < LatencyHistogram::NR_BUCKETS; ++i) {
+              msg.data.push_back(histogram.bucket(i));
+            }
+          }
+          reference_age_publisher_->publish(msg);
+        });
+  }
+
+  // Fault handling
+  fault_monitor_.configure(
+      params_.fault_handling.auto_recovery,
+      static_cast<std::size_t>(params_.fault_handling.recovery_cycles),
+      params_.fault_handling.stall_command_threshold,
+      params_.fault_handling.stall_velocity_threshold,
+      static_cast<std::size_t>(params_.fault_handling.stall_cycles));
+  // the mode publisher and the reset service only exist if enabled
+  fault_state_publisher_.reset();
+  fault_s_publisher_.reset();
+  if (params_.fault_handling.publish_state) {
+    try {
+      fault_s_publisher_ = get_node()->create_publisher<FaultStateMsg>(
+          "~/fault_state", rclcpp::SystemDefaultsQoS().transient_local());
+      fault_state_publisher_ =
+          std::make_unique<FaultStatePublisher>(fault_s_publisher_);
+    } catch (const std::exception &e) {
+      fprintf(stderr,
+              "Exception thrown during publisher creation at configure stage "
+              "with message : %s \n",
+              e.what());
+      return controller_interface::CallbackReturn::ERROR;
+    }
+  }
+  reset_fault_service_.reset();
+  if (params_.fault_handling.reset_service) {
+    reset_fault_service_ = get_node()->create_service<std_srvs::srv::Trigger>(
+        "~/reset_fault",
+        [this](const std::shared_ptr<std_srvs::srv::Trigger::Request>,
+               std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+          const auto mode = fault_monitor_.mode();
+          fault_monitor_.request_reset();
+          response->success = true;
+          response->message =
+              std::string("Reset requested in mode ") +
+              FaultMonitor::to_string(mode) +
+              (mode == ControllerMode::FAULT
+                   ? ", recovering as soon as the fault is cleared."
+                   : ", nothing to reset.");
+        });
+  } else if (!params_.fault_handling.auto_recovery) {
+    RCLCPP_WARN(get_node()->get_logger(),
+                "Neither auto recovery nor the reset service is enabled, a "
+                "FAULT is only left by deactivating and activating.");
+  }
+
   return controller_interface::CallbackReturn::SUCCESS;
 }
 
@@ -195,14 +568,51 @@ controller_interface::CallbackReturn MecanumDriveController::on_activate(
     const rclcpp_lifecycle::State &previous_state) {
   // Set default value in command
   reset_controller_reference_msg(*(input_ref_.readFromRT()), get_node());
+  load_shedder_.reset();
+  idle_detector_.reset();
+  fault_monitor_.reset();
+  velocity_estimator_.reset();
+  yaw_rate_controller_.reset();
+  state_statistics_.reset();
+  controller_state_cycle_ = 0;
+  reference_stale_ = false;
+  // publish the mode in the first cycle
+  is_mode_published_ = false;
+
+  // the interfaces are read and written in one pass per cycle each, the
+  // commands are mirrored here for the later readers of the cycle
+  nr_wheels_ = std::min(state_interfaces_.size(), command_interfaces_.size());
+  for (size_t i = 0; i < nr_wheels_; ++i) {
+    wheel_commands_[i] = command_interfaces_[i].get_value();
+  }
 
   return controller_interface::CallbackReturn::SUCCESS;
 }
 
 controller_interface::CallbackReturn MecanumDriveController::on_deactivate(
     const rclcpp_lifecycle::State &previous_state) {
-  for (size_t i = 0; i < NR_CMD_ITFS; ++i) {
-    command_interfaces_[i].set_value(std::numeric_limits<double>::quiet_NaN());
+  wheel_commands_.fill(std::numeric_limits<double>::quiet_NaN());
+  for (auto &command_interface : command_interfaces_) {
+    command_interface.set_value(std::numeric_limits<double>::quiet_NaN());
+  }
+
+  if (load_shedder_.enabled()) {
+    RCLCPP_INFO(
+        get_node()->get_logger(),
+        "Load shedding: %" PRIu64 " overrun cycles, shed stages: "
+        "introspection %" PRIu64 ", telemetry %" PRIu64
+        ", controller_state %" PRIu64 ", odometry %" PRIu64 ".",
+        load_shedder_.overrun_count(),
+        load_shedder_.shed_count(ShedStage::INTROSPECTION),
+        load_shedder_.shed_count(ShedStage::TELEMETRY),
+        load_shedder_.shed_count(ShedStage::CONTROLLER_STATE),
+        load_shedder_.shed_count(ShedStage::ODOMETRY_DECIMATION));
+  }
+  if (telemetry_recorder_ && telemetry_recorder_->dropped_count() > 0) {
+    RCLCPP_WARN(get_node()->get_logger(),
+                "Telemetry archive: %" PRIu64
+                " samples dropped on a full queue.",
+                telemetry_recorder_->dropped_count());
   }
   return controller_interface::CallbackReturn::SUCCESS;
 }
@@ -211,33 +621,38 @@ controller_interface::return_type
 MecanumDriveController::update_reference_from_subscribers(
     const rclcpp::Time &time, const rclcpp::Duration &period) {
   auto current_ref = *(input_ref_.readFromRT());
-  const auto age_of_last_command = time - (current_ref)->header.stamp;
+  topic_reference_age_ = std::chrono::nanoseconds(-1);
   bool is_msg_ok = is_msg_valid(current_ref);
 
   // returen if message not ok
+  // no reference is a stop, not a stale one, so a parked robot is RUNNING
   if (!is_msg_ok) {
+    reference_stale_ = false;
     return controller_interface::return_type::OK;
   }
 
+  // integer nanoseconds avoid the clock type checks of rclcpp::Time
+  const std::int64_t age_of_last_command =
+      time.nanoseconds() - to_nanoseconds(current_ref->header.stamp);
+  const bool is_in_time = age_of_last_command <= ref_timeout_nanoseconds_;
+  // a zero timeout applies each reference once, whatever its age
+  const bool is_applied = is_in_time || ref_timeout_nanoseconds_ == 0;
+
   // send only if msg valid and real in-time
-  if (age_of_last_command <= ref_timeout_) {
+  reference_stale_ = !is_applied;
+  if (is_applied) {
     reference_interfaces_[0] = current_ref->twist.linear.x;
     reference_interfaces_[1] = current_ref->twist.linear.y;
     reference_interfaces_[2] = current_ref->twist.angular.z;
-  } else if (ref_timeout_ == rclcpp::Duration::from_seconds(0)) {
-    // always send STOP if ref_timeout_ is 0.0
-    reference_interfaces_[0] = current_ref->twist.linear.x;
-    reference_interfaces_[1] = current_ref->twist.linear.y;
-    reference_interfaces_[2] = current_ref->twist.angular.z;
-    current_ref->twist.linear.x = std::numeric_limits<double>::quiet_NaN();
-    current_ref->twist.linear.y = std::numeric_limits<double>::quiet_NaN();
-    current_ref->twist.angular.z = std::numeric_limits<double>::quiet_NaN();
-  } else{
+    topic_reference_age_ = std::chrono::nanoseconds(age_of_last_command);
+  } else {
     // if command is ok, but timeout, send STOP
+    metrics_.count_reference_timeout();
     reference_interfaces_[0] = 0.0;
     reference_interfaces_[1] = 0.0;
     reference_interfaces_[2] = 0.0;
-
+  }
+  if (!is_in_time) {
     current_ref->twist.linear.x = std::numeric_limits<double>::quiet_NaN();
     current_ref->twist.linear.y = std::numeric_limits<double>::quiet_NaN();
     current_ref->twist.angular.z = std::numeric_limits<double>::quiet_NaN();
@@ -249,101 +664,195 @@ MecanumDriveController::update_reference_from_subscribers(
 controller_interface::return_type
 MecanumDriveController::update_and_write_commands(
     const rclcpp::Time &time, const rclcpp::Duration &period) {
+  // the clock is only read if someone consumes the cycle duration
+  const bool is_cycle_timed = load_shedder_.enabled() || metrics_exporter_;
+  const auto cycle_start = is_cycle_timed
+                               ? std::chrono::steady_clock::now()
+                               : std::chrono::steady_clock::time_point();
+  metrics_.count_cycle();
+
+  // WHEEL STATES.
+  // the wheels of the first base come first, a coupled second base follows;
+  // read once per cycle, all later users take them from this array
+  const size_t nr_wheels = nr_wheels_;
+  alignas(64) std::array<double, NR_COUPLED_WHEELS> wheel_state_vels;
+  for (size_t i = 0; i < nr_wheels; ++i) {
+    const double state = state_interfaces_[i].get_value();
+    wheel_state_vels[i] =
+        params_.velocity_estimation.enable
+            ? velocity_estimator_.update(i, state, period.seconds())
+            : state;
+  }
+  const bool wheel_states_valid =
+      std::none_of(wheel_state_vels.begin(),
+                   wheel_state_vels.begin() + nr_wheels,
+                   [](const double vel) { return std::isnan(vel); });
+
+  if (!wheel_states_valid) {
+    metrics_.count_invalid_wheel_states();
+  }
+
+  // IDLE DETECTION.
+  // a timed-out reference is zero, a missing one NaN
+  const bool is_idle =
+      idle_detector_.enabled() &&
+      idle_detector_.update(
+          std::any_of(reference_interfaces_.begin(),
+                      reference_interfaces_.begin() + NR_REF_ITFS,
+                      [](const double ref) {
+                        return !std::isnan(ref) && ref != 0.0;
+                      }),
+          wheel_state_vels.data(), nr_wheels,
+          std::chrono::nanoseconds(period.nanoseconds()));
+
   // FORWARD KINEMATICS (odometry).
-  const double wheel_front_left_state_vel =
-      state_interfaces_[FRONT_LEFT].get_value();
-  const double wheel_front_right_state_vel =
-      state_interfaces_[FRONT_RIGHT].get_value();
-  const double wheel_rear_right_state_vel =
-      state_interfaces_[REAR_RIGHT].get_value();
-  const double wheel_rear_left_state_vel =
-      state_interfaces_[REAR_LEFT].get_value();
-
-  if (!std::isnan(wheel_front_left_state_vel) &&
-      !std::isnan(wheel_rear_left_state_vel) &&
-      !std::isnan(wheel_rear_right_state_vel) &&
-      !std::isnan(wheel_front_right_state_vel)) {
+  // skipped while idle, the wheels are at standstill; the twist of the last
+  // active cycle is cleared once so `odom` does not report motion
+  if (is_idle && (odometry_.getVx() != 0.0 || odometry_.getVy() != 0.0 ||
+                  odometry_.getWz() != 0.0)) {
+    odometry_.updateFromTwist(BodyTwist(), 0.0, time.nanoseconds());
+  } else if (wheel_states_valid && !is_idle && params_.coupled.enable) {
+    // least-squares twist of the carrier out of the wheels of both bases
+    odometry_.updateFromTwist(coupled_kinematics_.forward(wheel_state_vels),
+                              period.seconds(), time.nanoseconds());
+  } else if (wheel_states_valid && !is_idle) {
     // Estimate twist (using joint information) and integrate
-    odometry_.update(wheel_front_left_state_vel, wheel_rear_left_state_vel,
-                     wheel_rear_right_state_vel, wheel_front_right_state_vel,
-                     period.seconds());
+    odometry_.update(wheel_state_vels[FRONT_LEFT], wheel_state_vels[REAR_LEFT],
+                     wheel_state_vels[REAR_RIGHT],
+                     wheel_state_vels[FRONT_RIGHT], period.seconds(),
+                     time.nanoseconds());
+  }
+
+  // YAW RATE FEEDBACK.
+  // NaN applies no correction, the odometry is not updated without valid
+  // wheel states or while idle
+  double measured_yaw_rate = std::numeric_limits<double>::quiet_NaN();
+  if (yaw_rate_from_imu_) {
+    measured_yaw_rate = state_interfaces_[nr_wheels].get_value();
+  } else if (params_.yaw_rate_feedback.enable && wheel_states_valid &&
+             !is_idle) {
+    measured_yaw_rate = odometry_.getWz();
+  }
+
+  // FAULT HANDLING.
+  FaultConditions fault_conditions;
+  fault_conditions.wheel_states_invalid = !wheel_states_valid;
+  if (wheel_states_valid) {
+    for (size_t i = 0; i < nr_wheels; ++i) {
+      // `|` instead of `||` so every wheel's stall counter is updated
+      fault_conditions.wheel_stalled =
+          fault_monitor_.check_stall(i, wheel_commands_[i],
+                                     wheel_state_vels[i]) |
+          fault_conditions.wheel_stalled;
+    }
   }
+  fault_conditions.reference_stale = reference_stale_;
+  fault_conditions.cycle_late =
+      params_.fault_handling.watchdog_period > 0.0 &&
+      period.seconds() > params_.fault_handling.watchdog_period;
+  const ControllerMode mode = fault_monitor_.update(fault_conditions);
 
   // INVERSE KINEMATICS (move robot).
   // Compute wheels velocities (this is the actual ik):
   // NOTE: the input desired twist (from topic `~/reference`) is a body twist.
-  if (!std::isnan(reference_interfaces_[0]) &&
+  if (mode != ControllerMode::FAULT && mode != ControllerMode::RECOVERING &&
+      !std::isnan(reference_interfaces_[0]) &&
       !std::isnan(reference_interfaces_[1]) &&
       !std::isnan(reference_interfaces_[2])) {
-    tf2::Quaternion quaternion;
-    quaternion.setRPY(0.0, 0.0, params_.kinematics.base_frame_offset.theta);
-    /// \note The variables meaning:
-    /// rotation_from_base_to_center: Rotation transformation matrix, to
-    /// transform from base frame to center frame
-    /// linear_trans_from_base_to_center: offset/linear transformation matrix,
-    /// to transform from base frame to center frame
-
-    tf2::Matrix3x3 rotation_from_base_to_center = tf2::Matrix3x3((quaternion));
-    tf2::Vector3 velocity_in_base_frame_w_r_t_center_frame_ =
-        rotation_from_base_to_center *
-        tf2::Vector3(reference_interfaces_[0], reference_interfaces_[1], 0.0);
-    tf2::Vector3 linear_trans_from_base_to_center =
-        tf2::Vector3(params_.kinematics.base_frame_offset.x,
-                     params_.kinematics.base_frame_offset.y, 0.0);
-
-    velocity_in_center_frame_linear_x_ =
-        velocity_in_base_frame_w_r_t_center_frame_.x() +
-        linear_trans_from_base_to_center.y() * reference_interfaces_[2];
-    velocity_in_center_frame_linear_y_ =
-        velocity_in_base_frame_w_r_t_center_frame_.y() -
-        linear_trans_from_base_to_center.x() * reference_interfaces_[2];
-    velocity_in_center_frame_angular_z_ = reference_interfaces_[2];
-
-    const double wheel_front_left_vel =
-        1.0 / params_.kinematics.wheels_radius *
-        (velocity_in_center_frame_linear_x_ -
-         velocity_in_center_frame_linear_y_ -
-         params_.kinematics.sum_of_robot_center_projection_on_X_Y_axis *
-             velocity_in_center_frame_angular_z_);
-    const double wheel_front_right_vel =
-        1.0 / params_.kinematics.wheels_radius *
-        (velocity_in_center_frame_linear_x_ +
-         velocity_in_center_frame_linear_y_ +
-         params_.kinematics.sum_of_robot_center_projection_on_X_Y_axis *
-             velocity_in_center_frame_angular_z_);
-    const double wheel_rear_right_vel =
-        1.0 / params_.kinematics.wheels_radius *
-        (velocity_in_center_frame_linear_x_ -
-         velocity_in_center_frame_linear_y_ +
-         params_.kinematics.sum_of_robot_center_projection_on_X_Y_axis *
-             velocity_in_center_frame_angular_z_);
-    const double wheel_rear_left_vel =
-        1.0 / params_.kinematics.wheels_radius *
-        (velocity_in_center_frame_linear_x_ +
-         velocity_in_center_frame_linear_y_ -
-         params_.kinematics.sum_of_robot_center_projection_on_X_Y_axis *
-             velocity_in_center_frame_angular_z_);
-
-    // Set wheels velocities - The joint names are sorted accoring to the order
-    // documented in the header file!
-    command_interfaces_[FRONT_LEFT].set_value(wheel_front_left_vel);
-    command_interfaces_[FRONT_RIGHT].set_value(wheel_front_right_vel);
-    command_interfaces_[REAR_RIGHT].set_value(wheel_rear_right_vel);
-    command_interfaces_[REAR_LEFT].set_value(wheel_rear_left_vel);
+    BodyTwist reference{reference_interfaces_[0], reference_interfaces_[1],
+                        reference_interfaces_[2]};
+    // the clock is read once around all stages, an empty pipeline is not
+    // timed
+    if (is_cycle_timed && reference_pipeline_.size() > 0) {
+      const auto pipeline_start = std::chrono::steady_clock::now();
+      reference_pipeline_.process(reference);
+      metrics_.record_reference_pipeline_duration(
+          std::chrono::steady_clock::now() - pipeline_start);
+    } else {
+      reference_pipeline_.process(reference);
+    }
+
+    // the twist is given about the rotation center, if set
+    const auto twist = twist_about_point(
+        reference,
+        std::isnan(reference_interfaces_[ROTATION_CENTER_X])
+            ? 0.0
+            : reference_interfaces_[ROTATION_CENTER_X],
+        std::isnan(reference_interfaces_[ROTATION_CENTER_Y])
+            ? 0.0
+            : reference_interfaces_[ROTATION_CENTER_Y]);
+    double reference_linear_x = twist.linear_x;
+    double reference_linear_y = twist.linear_y;
+    if (params_.obstacle_speed_limit.enable) {
+      apply_obstacle_speed_limit(time, period, reference_linear_x,
+                                 reference_linear_y);
+    }
+    const double reference_angular_z =
+        params_.yaw_rate_feedback.enable
+            ? yaw_rate_controller_.update(twist.angular_z, measured_yaw_rate,
+                                          period.seconds())
+            : twist.angular_z;
+
+    if (params_.coupled.enable) {
+      // one twist of the carrier for both bases keeps them from drifting
+      // apart
+      wheel_commands_ = coupled_kinematics_.inverse(
+          {reference_linear_x, reference_linear_y, reference_angular_z});
+    } else {
+      // The joint names are sorted according to the order documented in the
+      // header file!
+      const auto wheel_vels = inverse_kinematics(
+          kinematics_params_,
+          {reference_linear_x, reference_linear_y, reference_angular_z});
+      std::copy(wheel_vels.begin(), wheel_vels.end(), wheel_commands_.begin());
+    }
+
+    // chained references carry no stamp, only topic ones have an age
+    if (topic_reference_age_.count() >= 0) {
+      metrics_.record_reference_age(ReferenceInput::TOPIC,
+                                    topic_reference_age_);
+    }
   } else {
-    command_interfaces_[FRONT_LEFT].set_value(0.0);
-    command_interfaces_[FRONT_RIGHT].set_value(0.0);
-    command_interfaces_[REAR_RIGHT].set_value(0.0);
-    command_interfaces_[REAR_LEFT].set_value(0.0);
+    std::fill(wheel_commands_.begin(), wheel_commands_.begin() + nr_wheels,
+              0.0);
+    yaw_rate_controller_.reset();
   }
 
-  // Publish odometry message
-  // Compute and store orientation info
-  tf2::Quaternion orientation;
-  orientation.setRPY(0.0, 0.0, odometry_.getRz());
+  // Set wheels velocities in one pass
+  for (size_t i = 0; i < nr_wheels; ++i) {
+    command_interfaces_[i].set_value(wheel_commands_[i]);
+  }
+
+  if (telemetry_recorder_ &&
+      load_shedder_.should_run(ShedStage::TELEMETRY) &&
+      telemetry_cycle_++ % static_cast<std::size_t>(
+                               params_.telemetry_archive.decimation) ==
+          0) {
+    TelemetrySample sample;
+    sample.stamp_nanoseconds = time.nanoseconds();
+    for (size_t i = 0; i < NR_CMD_ITFS; ++i) {
+      sample.values[FRONT_LEFT_STATE + i] = wheel_state_vels[i];
+      sample.values[FRONT_LEFT_COMMAND + i] = wheel_commands_[i];
+    }
+    sample.values[ODOMETRY_X] = odometry_.getX();
+    sample.values[ODOMETRY_Y] = odometry_.getY();
+    sample.values[ODOMETRY_RZ] = odometry_.getRz();
+    sample.values[ODOMETRY_VX] = odometry_.getVx();
+    sample.values[ODOMETRY_VY] = odometry_.getVy();
+    sample.values[ODOMETRY_WZ] = odometry_.getWz();
+    // drops are counted by the recorder
+    telemetry_recorder_->record(sample);
+  }
 
+  // Publish odometry message
   // Populate odom message and publish
-  if (rt_odom_state_publisher_->trylock()) {
+  const bool is_odometry_due = idle_detector_.should_publish() &&
+                               load_shedder_.should_publish_odometry();
+  if (is_odometry_due && rt_odom_state_publisher_->trylock()) {
+    // Compute and store orientation info
+    tf2::Quaternion orientation;
+    orientation.setRPY(0.0, 0.0, odometry_.getRz());
+
     rt_odom_state_publisher_->msg_.header.stamp = time;
     rt_odom_state_publisher_->msg_.pose.pose.position.x = odometry_.getX();
     rt_odom_state_publisher_->msg_.pose.pose.position.y = odometry_.getY();
@@ -353,18 +862,64 @@ MecanumDriveController::update_and_write_commands(
     rt_odom_state_publisher_->msg_.twist.twist.linear.y = odometry_.getVy();
     rt_odom_state_publisher_->msg_.twist.twist.angular.z = odometry_.getWz();
     rt_odom_state_publisher_->unlockAndPublish();
+  } else if (is_odometry_due) {
+    metrics_.count_dropped_publish(MetricsPublisher::ODOMETRY);
+  }
+
+  // introspection outputs are the first to be shed, skipped ones are retried
+  const bool is_introspection_run =
+      load_shedder_.should_run(ShedStage::INTROSPECTION);
+
+  // publish mode changes, retried until the publisher is free
+  const bool is_mode_due = fault_state_publisher_ && is_introspection_run &&
+                           (!is_mode_published_ || mode != published_mode_);
+  if (is_mode_due && fault_state_publisher_->trylock()) {
+    fault_state_publisher_->msg_.data = static_cast<std::uint8_t>(mode);
+    fault_state_publisher_->unlockAndPublish();
+    published_mode_ = mode;
+    is_mode_published_ = true;
+  } else if (is_mode_due) {
+    metrics_.count_dropped_publish(MetricsPublisher::FAULT_STATE);
+  }
+
+  if (params_.map_pose.enable) {
+    publish_map_pose(time, is_introspection_run);
+  }
+
+  // statistics see every cycle, also the ones without a published state
+  if (state_statistics_publisher_) {
+    std::array<double, NR_STATE_STATISTICS_SIGNALS> statistics_sample;
+    for (size_t i = 0; i < NR_STATE_ITFS; ++i) {
+      statistics_sample[i] = wheel_state_vels[i];
+    }
+    for (size_t i = 0; i < NR_CMD_ITFS; ++i) {
+      statistics_sample[NR_STATE_ITFS + i] = wheel_commands_[i];
+    }
+    for (size_t i = 0; i < NR_REF_ITFS; ++i) {
+      statistics_sample[NR_STATE_ITFS + NR_CMD_ITFS + i] =
+          reference_interfaces_[i];
+    }
+    state_statistics_.add(statistics_sample);
   }
 
-  if (controller_state_publisher_->trylock()) {
+  // a state not published due to shedding, idling or a busy publisher is
+  // retried in the next cycle, its statistics window grows meanwhile
+  const bool is_state_due =
+      ++controller_state_cycle_ >=
+          static_cast<size_t>(params_.controller_state_decimation) &&
+      load_shedder_.should_run(ShedStage::CONTROLLER_STATE) &&
+      idle_detector_.should_publish();
+  if (is_state_due && controller_state_publisher_->trylock()) {
+    controller_state_cycle_ = 0;
     controller_state_publisher_->msg_.header.stamp = get_node()->now();
     controller_state_publisher_->msg_.front_left_wheel_velocity =
-        state_interfaces_[FRONT_LEFT].get_value();
+        wheel_state_vels[FRONT_LEFT];
     controller_state_publisher_->msg_.front_right_wheel_velocity =
-        state_interfaces_[FRONT_RIGHT].get_value();
+        wheel_state_vels[FRONT_RIGHT];
     controller_state_publisher_->msg_.back_right_wheel_velocity =
-        state_interfaces_[REAR_RIGHT].get_value();
+        wheel_state_vels[REAR_RIGHT];
     controller_state_publisher_->msg_.back_left_wheel_velocity =
-        state_interfaces_[REAR_LEFT].get_value();
+        wheel_state_vels[REAR_LEFT];
     controller_state_publisher_->msg_.reference_velocity.linear.x =
         reference_interfaces_[0];
     controller_state_publisher_->msg_.reference_velocity.linear.y =
@@ -372,11 +927,49 @@ MecanumDriveController::update_and_write_commands(
     controller_state_publisher_->msg_.reference_velocity.angular.z =
         reference_interfaces_[2];
     controller_state_publisher_->unlockAndPublish();
+
+    // shed statistics keep their window growing until the next state
+    const bool is_statistics_due =
+        state_statistics_publisher_ && is_introspection_run;
+    if (is_statistics_due && state_statistics_publisher_->trylock()) {
+      auto &data = state_statistics_publisher_->msg_.data;
+      for (size_t i = 0; i < NR_STATE_STATISTICS_SIGNALS; ++i) {
+        data[3 * i] = state_statistics_.min(i);
+        data[3 * i + 1] = state_statistics_.max(i);
+        data[3 * i + 2] = state_statistics_.mean(i);
+      }
+      state_statistics_publisher_->unlockAndPublish();
+      state_statistics_.reset();
+    } else if (is_statistics_due) {
+      metrics_.count_dropped_publish(
+          MetricsPublisher::CONTROLLER_STATE_STATISTICS);
+    }
+  } else if (is_state_due) {
+    metrics_.count_dropped_publish(MetricsPublisher::CONTROLLER_STATE);
   }
 
   reference_interfaces_[0] = std::numeric_limits<double>::quiet_NaN();
   reference_interfaces_[1] = std::numeric_limits<double>::quiet_NaN();
   reference_interfaces_[2] = std::numeric_limits<double>::quiet_NaN();
+  reference_interfaces_[ROTATION_CENTER_X] =
+      std::numeric_limits<double>::quiet_NaN();
+  reference_interfaces_[ROTATION_CENTER_Y] =
+      std::numeric_limits<double>::quiet_NaN();
+  reference_interfaces_[MAP_CORRECTION_X] =
+      std::numeric_limits<double>::quiet_NaN();
+  reference_interfaces_[MAP_CORRECTION_Y] =
+      std::numeric_limits<double>::quiet_NaN();
+  reference_interfaces_[MAP_CORRECTION_RZ] =
+      std::numeric_limits<double>::quiet_NaN();
+  topic_reference_age_ = std::chrono::nanoseconds(-1);
+
+  if (is_cycle_timed) {
+    const auto cycle_duration = std::chrono::steady_clock::now() - cycle_start;
+    if (load_shedder_.enabled()) {
+      load_shedder_.update(cycle_duration);
+    }
+    metrics_.record_cycle_duration(cycle_duration);
+  }
 
   return controller_interface::return_type::OK;
 }
@@ -390,33 +983,181 @@ void MecanumDriveController::reference_callback(
                 "timestamp.");
     msg->header.stamp = get_node()->now();
   }
-  const auto age_of_last_command = get_node()->now() - msg->header.stamp;
+  const std::int64_t age_of_last_command =
+      get_node()->now().nanoseconds() - to_nanoseconds(msg->header.stamp);
 
-  if (ref_timeout_ == rclcpp::Duration::from_seconds(0) ||
-      age_of_last_command <= ref_timeout_) {
+  if (ref_timeout_nanoseconds_ == 0 ||
+      age_of_last_command <= ref_timeout_nanoseconds_) {
     input_ref_.writeFromNonRT(msg);
   } else {
     RCLCPP_ERROR(get_node()->get_logger(),
                  "Received message has timestamp %.10f older for %.10f which "
                  "is more then allowed timeout "
                  "(%.4f).",
-                 rclcpp::Time(msg->header.stamp).seconds(),
-                 age_of_last_command.seconds(), ref_timeout_.seconds());
+                 1e-9 * static_cast<double>(to_nanoseconds(msg->header.stamp)),
+                 1e-9 * static_cast<double>(age_of_last_command),
+                 1e-9 * static_cast<double>(ref_timeout_nanoseconds_));
     reset_controller_reference_msg(msg, get_node());
   }
 }
 
+void MecanumDriveController::socket_reference_callback(
+    const ReferenceFrame &frame) {
+  auto msg = std::make_shared<ControllerReferenceMsg>();
+  // frames without stamp are stamped on reception
+  if (frame.stamp_nanoseconds == 0) {
+    msg->header.stamp = get_node()->now();
+  } else {
+    msg->header.stamp = rclcpp::Time(
+        frame.stamp_nanoseconds, get_node()->get_clock()->get_clock_type());
+  }
+  msg->twist.linear.x = frame.linear_x;
+  msg->twist.linear.y = frame.linear_y;
+  msg->twist.linear.z = std::numeric_limits<double>::quiet_NaN();
+  msg->twist.angular.x = std::numeric_limits<double>::quiet_NaN();
+  msg->twist.angular.y = std::numeric_limits<double>::quiet_NaN();
+  msg->twist.angular.z = frame.angular_z;
+  reference_callback(msg);
+}
+
+void MecanumDriveController::obstacle_distances_callback(
+    const std::shared_ptr<ObstacleDistancesMsg> msg) {
+  if (msg->data.size() != 4) {
+    RCLCPP_WARN(get_node()->get_logger(),
+                "Obstacle distances have to contain 4 values [front, rear, "
+                "left, right], received %zu. Message is ignored.",
+                msg->data.size());
+    return;
+  }
+  ObstacleDistances distances;
+  distances.stamp_nanoseconds = get_node()->now().nanoseconds();
+  distances.front = msg->data[0];
+  distances.rear = msg->data[1];
+  distances.left = msg->data[2];
+  distances.right = msg->data[3];
+  obstacle_distances_.store(distances);
+}
+
+void MecanumDriveController::map_correction_callback(
+    const std::shared_ptr<MapCorrectionMsg> msg) {
+  if ((!msg->header.frame_id.empty() &&
+       msg->header.frame_id != params_.map_pose.frame_id) ||
+      (!msg->child_frame_id.empty() &&
+       msg->child_frame_id != params_.odom_frame_id)) {
+    RCLCPP_WARN(get_node()->get_logger(),
+                "Map correction has to be the transform from '%s' to '%s', "
+                "received '%s' to '%s'. Message is ignored.",
+                params_.map_pose.frame_id.c_str(),
+                params_.odom_frame_id.c_str(), msg->header.frame_id.c_str(),
+                msg->child_frame_id.c_str());
+    return;
+  }
+  double roll, pitch, yaw;
+  tf2::Matrix3x3(tf2::Quaternion(msg->transform.rotation.x,
+                                 msg->transform.rotation.y,
+                                 msg->transform.rotation.z,
+                                 msg->transform.rotation.w))
+      .getRPY(roll, pitch, yaw);
+
+  MapCorrection correction;
+  // a correction without stamp is taken as current
+  correction.stamp_nanoseconds =
+      msg->header.stamp.sec == 0 && msg->header.stamp.nanosec == 0u
+          ? get_node()->now().nanoseconds()
+          : rclcpp::Time(msg->header.stamp).nanoseconds();
+  correction.map_to_odom = {msg->transform.translation.x,
+                            msg->transform.translation.y, yaw};
+  map_correction_.store(correction);
+}
+
+void MecanumDriveController::publish_map_pose(const rclcpp::Time &time,
+                                             const bool is_publish_allowed) {
+  // a chained correction is consumed in the cycle it is written
+  if (!std::isnan(reference_interfaces_[MAP_CORRECTION_X]) &&
+      !std::isnan(reference_interfaces_[MAP_CORRECTION_Y]) &&
+      !std::isnan(reference_interfaces_[MAP_CORRECTION_RZ])) {
+    last_map_correction_.stamp_nanoseconds = time.nanoseconds();
+    last_map_correction_.map_to_odom = {
+        reference_interfaces_[MAP_CORRECTION_X],
+        reference_interfaces_[MAP_CORRECTION_Y],
+        reference_interfaces_[MAP_CORRECTION_RZ]};
+  }
+
+  if (++map_pose_cycle_ < static_cast<size_t>(params_.map_pose.decimation)) {
+    return;
+  }
+  MapCorrection correction;
+  // the subscriber is just writing, its correction is taken next time
+  if (map_correction_.try_load(correction) &&
+      correction.stamp_nanoseconds > last_map_correction_.stamp_nanoseconds) {
+    last_map_correction_ = correction;
+  }
+  // a shed pose is retried in the next cycle
+  if (last_map_correction_.stamp_nanoseconds == 0 || !is_publish_allowed) {
+    return;
+  }
+
+  if (map_pose_publisher_->trylock()) {
+    map_pose_cycle_ = 0;
+    const auto pose = compose_poses(
+        last_map_correction_.map_to_odom,
+        {odometry_.getX(), odometry_.getY(), odometry_.getRz()});
+    tf2::Quaternion orientation;
+    orientation.setRPY(0.0, 0.0, pose.rz);
+
+    map_pose_publisher_->msg_.header.stamp = time;
+    map_pose_publisher_->msg_.pose.position.x = pose.x;
+    map_pose_publisher_->msg_.pose.position.y = pose.y;
+    map_pose_publisher_->msg_.pose.orientation = tf2::toMsg(orientation);
+    map_pose_publisher_->unlockAndPublish();
+  } else {
+    metrics_.count_dropped_publish(MetricsPublisher::MAP_POSE);
+  }
+}
+
+void MecanumDriveController::apply_obstacle_speed_limit(
+    const rclcpp::Time &time, const rclcpp::Duration &period,
+    double &linear_x, double &linear_y) {
+  ObstacleDistances distances;
+  if (!obstacle_distances_.try_load(distances)) {
+    // the subscriber is just writing, distances of last cycle are close enough
+    distances = last_obstacle_distances_;
+  }
+  last_obstacle_distances_ = distances;
+
+  if (distances.stamp_nanoseconds == 0 ||
+      (obstacle_timeout_nanoseconds_ > 0 &&
+       time.nanoseconds() - distances.stamp_nanoseconds >
+           obstacle_timeout_nanoseconds_)) {
+    // no valid distances, stop
+    linear_x = 0.0;
+    linear_y = 0.0;
+    return;
+  }
+
+  limit_velocity_by_obstacle_distances(
+      distances, params_.obstacle_speed_limit.deceleration_x,
+      params_.obstacle_speed_limit.deceleration_y,
+      params_.obstacle_speed_limit.stop_margin,
+      params_.obstacle_speed_limit.reaction_time + period.seconds(), linear_x,
+      linear_y);
+}
+
 std::vector<hardware_interface::CommandInterface>
 MecanumDriveController::on_export_reference_interfaces() {
-  reference_interfaces_.resize(NR_REF_ITFS,
-                               std::numeric_limits<double>::quiet_NaN());
+  reference_interfaces_.resize(
+      NR_REF_ITFS + NR_ROTATION_CENTER_ITFS + NR_MAP_CORRECTION_ITFS,
+      std::numeric_limits<double>::quiet_NaN());
 
   std::vector<hardware_interface::CommandInterface> reference_interfaces;
 
   reference_interfaces.reserve(reference_interfaces_.size());
 
   std::vector<std::string> reference_interface_names = {
-      "linear/x/velocity", "linear/y/velocity", "angular/z/velocity"};
+      "linear/x/velocity", "linear/y/velocity", "angular/z/velocity",
+      "rotation_center/x/position", "rotation_center/y/position",
+      "map_correction/x/position", "map_correction/y/position",
+      "map_correction/rz/position"};
 
   for (size_t i = 0; i < reference_interfaces_.size(); ++i) {
     reference_interfaces.push_back(hardware_interface::CommandInterface(
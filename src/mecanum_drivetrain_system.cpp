@@ -0,0 +1,178 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/mecanum_drivetrain_system.hpp"
+
+#include <string>
+#include <unordered_map>
+
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
+#include "rclcpp/logging.hpp"
+
+namespace { // utility
+
+rclcpp::Logger get_logger() {
+  return rclcpp::get_logger("MecanumDrivetrainSystem");
+}
+
+// reads an optional numeric parameter, false if it is malformed
+bool get_parameter(const std::unordered_map<std::string, std::string> &map,
+                   const std::string &name, double &value) {
+  const auto it = map.find(name);
+  if (it == map.end()) {
+    return true;
+  }
+  try {
+    value = std::stod(it->second);
+  } catch (const std::exception &) {
+    RCLCPP_ERROR(get_logger(), "Parameter '%s' is not a number: '%s'",
+                 name.c_str(), it->second.c_str());
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+namespace mecanum_drive_controller {
+hardware_interface::CallbackReturn
+MecanumDrivetrainSystem::on_init(const hardware_interface::HardwareInfo &info) {
+  if (hardware_interface::SystemInterface::on_init(info) !=
+      hardware_interface::CallbackReturn::SUCCESS) {
+    return hardware_interface::CallbackReturn::ERROR;
+  }
+
+  if (info_.joints.size() != NR_WHEELS) {
+    RCLCPP_ERROR(get_logger(),
+                 "Expected %zu joints (front left, front right, rear right, "
+                 "rear left), got %zu.",
+                 NR_WHEELS, info_.joints.size());
+    return hardware_interface::CallbackReturn::ERROR;
+  }
+
+  DrivetrainModelParams params;
+  params.kinematics.wheels_radius = 0.05;
+  params.kinematics.sum_of_robot_center_projection_on_X_Y_axis = 0.5;
+  double slip_ratio = 0.0;
+  const auto &parameters = info_.hardware_parameters;
+  if (!get_parameter(parameters, "wheels_radius",
+                     params.kinematics.wheels_radius) ||
+      !get_parameter(
+          parameters, "sum_of_robot_center_projection_on_X_Y_axis",
+          params.kinematics.sum_of_robot_center_projection_on_X_Y_axis) ||
+      !get_parameter(parameters, "time_constant", params.time_constant) ||
+      !get_parameter(parameters, "max_velocity", params.max_velocity) ||
+      !get_parameter(parameters, "encoder_resolution",
+                     params.encoder_resolution) ||
+      !get_parameter(parameters, "command_delay", params.command_delay) ||
+      !get_parameter(parameters, "slip_ratio", slip_ratio)) {
+    return hardware_interface::CallbackReturn::ERROR;
+  }
+
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    const auto &joint = info_.joints[i];
+    if (joint.command_interfaces.size() != 1 ||
+        joint.command_interfaces[0].name !=
+            hardware_interface::HW_IF_VELOCITY) {
+      RCLCPP_ERROR(get_logger(),
+                   "Joint '%s' needs exactly one '%s' command interface.",
+                   joint.name.c_str(), hardware_interface::HW_IF_VELOCITY);
+      return hardware_interface::CallbackReturn::ERROR;
+    }
+    params.slip_ratio[i] = slip_ratio;
+    if (!get_parameter(joint.parameters, "slip_ratio",
+                       params.slip_ratio[i])) {
+      return hardware_interface::CallbackReturn::ERROR;
+    }
+    if (params.slip_ratio[i] < 0.0 || params.slip_ratio[i] >= 1.0) {
+      RCLCPP_ERROR(get_logger(), "Slip ratio of joint '%s' is not in [0, 1).",
+                   joint.name.c_str());
+      return hardware_interface::CallbackReturn::ERROR;
+    }
+  }
+
+  if (params.kinematics.wheels_radius <= 0.0 || params.time_constant < 0.0 ||
+      params.max_velocity < 0.0 || params.encoder_resolution < 0.0 ||
+      params.command_delay < 0.0) {
+    RCLCPP_ERROR(get_logger(), "The wheels radius has to be positive and the "
+                               "other parameters must not be negative.");
+    return hardware_interface::CallbackReturn::ERROR;
+  }
+
+  model_.configure(params);
+  return hardware_interface::CallbackReturn::SUCCESS;
+}
+
+std::vector<hardware_interface::StateInterface>
+MecanumDrivetrainSystem::export_state_interfaces() {
+  std::vector<hardware_interface::StateInterface> state_interfaces;
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    state_interfaces.emplace_back(info_.joints[i].name,
+                                  hardware_interface::HW_IF_POSITION,
+                                  &positions_[i]);
+    state_interfaces.emplace_back(info_.joints[i].name,
+                                  hardware_interface::HW_IF_VELOCITY,
+                                  &velocities_[i]);
+  }
+  const std::string ground_truth = info_.name + "_ground_truth";
+  state_interfaces.emplace_back(ground_truth, "x", &ground_truth_[0]);
+  state_interfaces.emplace_back(ground_truth, "y", &ground_truth_[1]);
+  state_interfaces.emplace_back(ground_truth, "rz", &ground_truth_[2]);
+  return state_interfaces;
+}
+
+std::vector<hardware_interface::CommandInterface>
+MecanumDrivetrainSystem::export_command_interfaces() {
+  std::vector<hardware_interface::CommandInterface> command_interfaces;
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    command_interfaces.emplace_back(info_.joints[i].name,
+                                    hardware_interface::HW_IF_VELOCITY,
+                                    &commands_[i]);
+  }
+  return command_interfaces;
+}
+
+hardware_interface::CallbackReturn MecanumDrivetrainSystem::on_activate(
+    const rclcpp_lifecycle::State & /*previous_state*/) {
+  model_.reset();
+  commands_.fill(0.0);
+  positions_.fill(0.0);
+  velocities_.fill(0.0);
+  ground_truth_.fill(0.0);
+  return hardware_interface::CallbackReturn::SUCCESS;
+}
+
+hardware_interface::return_type
+MecanumDrivetrainSystem::read(const rclcpp::Time & /*time*/,
+                              const rclcpp::Duration &period) {
+  model_.step(period.seconds());
+  positions_ = model_.positions();
+  velocities_ = model_.velocities();
+  ground_truth_ = {model_.pose().x, model_.pose().y, model_.pose().rz};
+  return hardware_interface::return_type::OK;
+}
+
+hardware_interface::return_type
+MecanumDrivetrainSystem::write(const rclcpp::Time & /*time*/,
+                               const rclcpp::Duration & /*period*/) {
+  model_.set_commands(commands_);
+  return hardware_interface::return_type::OK;
+}
+
+} // namespace mecanum_drive_controller
+
+#include "pluginlib/class_list_macros.hpp"
+
+PLUGINLIB_EXPORT_CLASS(mecanum_drive_controller::MecanumDrivetrainSystem,
+                       hardware_interface::SystemInterface)
@@ -0,0 +1,208 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/metrics_exporter.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace { // utility
+
+constexpr int POLL_TIMEOUT_MS = 100;
+
+bool send_all(const int fd, const std::string &data) {
+  std::size_t sent = 0;
+  while (sent < data.size()) {
+    const auto size =
+        ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (size <= 0) {
+      return false;
+    }
+    sent += static_cast<std::size_t>(size);
+  }
+  return true;
+}
+
+std::string http_response(const char *status, const std::string &body) {
+  return std::string("HTTP/1.1 ") + status +
+         "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8"
+         "\r\nContent-Length: " +
+         std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+}
+
+} // namespace
+
+namespace mecanum_drive_controller {
+MetricsExporter::MetricsExporter()
+    : type_(Type::FILE), period_(0), fd_(-1), http_port_(0), running_(false),
+      export_count_(0) {}
+
+MetricsExporter::~MetricsExporter() { stop(); }
+
+bool MetricsExporter::start(const Type type, const std::string &file_path,
+                            const std::uint16_t http_port,
+                            const std::chrono::milliseconds period,
+                            Renderer renderer) {
+  stop();
+  error_.clear();
+  type_ = type;
+  renderer_ = std::move(renderer);
+
+  if (type == Type::FILE) {
+    if (file_path.empty() || period.count() <= 0) {
+      error_ = "metrics file path must be set and the period positive";
+      return false;
+    }
+    file_path_ = file_path;
+    period_ = period;
+    // fail early on an unwritable directory
+    if (!write_file()) {
+      return false;
+    }
+    running_ = true;
+    thread_ = std::thread(&MetricsExporter::run_file, this);
+    return true;
+  }
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(http_port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd_ < 0) {
+    error_ = std::string("socket creation failed: ") + std::strerror(errno);
+    return false;
+  }
+  const int reuse = 1;
+  ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  socklen_t length = sizeof(address);
+  if (::bind(fd_, reinterpret_cast<const sockaddr *>(&address),
+             sizeof(address)) != 0 ||
+      ::listen(fd_, 4) != 0 ||
+      ::getsockname(fd_, reinterpret_cast<sockaddr *>(&address), &length) !=
+          0) {
+    error_ = "listen on 127.0.0.1:" + std::to_string(http_port) +
+             " failed: " + std::strerror(errno);
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  http_port_ = ntohs(address.sin_port);
+
+  running_ = true;
+  thread_ = std::thread(&MetricsExporter::run_http, this);
+  return true;
+}
+
+void MetricsExporter::stop() {
+  const bool was_running = running_.exchange(false);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  if (was_running && type_ == Type::FILE) {
+    write_file();
+  }
+}
+
+bool MetricsExporter::write_file() {
+  // write a temporary file and rename it so scrapers never read partial data
+  const std::string tmp_path = file_path_ + ".tmp";
+  std::FILE *file = std::fopen(tmp_path.c_str(), "w");
+  if (file == nullptr) {
+    error_ = "cannot open '" + tmp_path + "': " + std::strerror(errno);
+    return false;
+  }
+  const std::string text = renderer_();
+  const bool written =
+      std::fwrite(text.data(), 1, text.size(), file) == text.size();
+  if (std::fclose(file) != 0 || !written ||
+      std::rename(tmp_path.c_str(), file_path_.c_str()) != 0) {
+    error_ = "cannot write '" + file_path_ + "': " + std::strerror(errno);
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  export_count_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void MetricsExporter::run_file() {
+  auto next = std::chrono::steady_clock::now() + period_;
+  while (running_) {
+    // sleep in short steps to stop promptly
+    const auto now = std::chrono::steady_clock::now();
+    if (now < next) {
+      std::this_thread::sleep_for(
+          std::min<std::chrono::steady_clock::duration>(
+              next - now, std::chrono::milliseconds(POLL_TIMEOUT_MS)));
+      continue;
+    }
+    write_file();
+    next += period_;
+    if (next < now) {
+      next = now + period_;
+    }
+  }
+}
+
+void MetricsExporter::run_http() {
+  pollfd descriptor{fd_, POLLIN, 0};
+  std::array<char, 1024> request;
+
+  while (running_) {
+    if (::poll(&descriptor, 1, POLL_TIMEOUT_MS) <= 0) {
+      continue;
+    }
+    const int client = ::accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (client < 0) {
+      continue;
+    }
+
+    // only the request line is of interest, wait for it briefly
+    pollfd client_descriptor{client, POLLIN, 0};
+    ssize_t size = 0;
+    if (::poll(&client_descriptor, 1, POLL_TIMEOUT_MS) > 0) {
+      size = ::recv(client, request.data(), request.size() - 1, 0);
+    }
+    if (size > 0) {
+      request[static_cast<std::size_t>(size)] = '\0';
+      const bool is_metrics =
+          std::strncmp(request.data(), "GET / ", 6) == 0 ||
+          std::strncmp(request.data(), "GET /metrics ", 13) == 0;
+      if (is_metrics) {
+        send_all(client, http_response("200 OK", renderer_()));
+        export_count_.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        send_all(client, http_response("404 Not Found", "not found\n"));
+      }
+    }
+    ::close(client);
+  }
+}
+
+} // namespace mecanum_drive_controller
@@ -14,99 +14,80 @@
 
 #include "mecanum_drive_controller/odometry.hpp"
 
-#include "tf2/transform_datatypes.h"
-#include "tf2_geometry_msgs/tf2_geometry_msgs.hpp"
-
 namespace mecanum_drive_controller {
-Odometry::Odometry()
-    : timestamp_(0.0), position_x_in_base_frame_(0.0),
-      position_y_in_base_frame_(0.0), orientation_z_in_base_frame_(0.0),
-      velocity_in_base_frame_linear_x(0.0),
-      velocity_in_base_frame_linear_y(0.0),
-      velocity_in_base_frame_angular_z(0.0),
-      sum_of_robot_center_projection_on_X_Y_axis_(0.0), wheels_radius_(0.0) {}
+Odometry::Odometry() : timestamp_nanoseconds_(0) {
+  pose_covariance_diagonal_.fill(0.0);
+  twist_covariance_diagonal_.fill(0.0);
+}
+
+void Odometry::init(const rclcpp::Time &time,
+                    std::array<double, PLANAR_POINT_DIM> base_frame_offset) {
+  timestamp_nanoseconds_ = time.nanoseconds();
+  kinematics_params_.base_frame_offset = base_frame_offset;
+
+  pose_ = Pose2D();
+  twist_ = BodyTwist();
+
+  publishSnapshot();
+}
+
+void Odometry::setCovarianceDiagonals(
+    const std::array<double, 6> &pose_covariance,
+    const std::array<double, 6> &twist_covariance) {
+  pose_covariance_diagonal_ = pose_covariance;
+  twist_covariance_diagonal_ = twist_covariance;
+}
+
+void Odometry::publishSnapshot() {
+  OdometrySnapshot snapshot;
+  snapshot.stamp_nanoseconds = timestamp_nanoseconds_;
+  snapshot.x = pose_.x;
+  snapshot.y = pose_.y;
+  snapshot.rz = pose_.rz;
+  snapshot.vx = twist_.linear_x;
+  snapshot.vy = twist_.linear_y;
+  snapshot.wz = twist_.angular_z;
+  snapshot.pose_covariance_diagonal = pose_covariance_diagonal_;
+  snapshot.twist_covariance_diagonal = twist_covariance_diagonal_;
+  snapshot_.store(snapshot);
+}
 
 void Odometry::setWheelsParams(
     const double sum_of_robot_center_projection_on_X_Y_axis,
     const double wheels_radius) {
-  sum_of_robot_center_projection_on_X_Y_axis_ =
+  kinematics_params_.sum_of_robot_center_projection_on_X_Y_axis =
       sum_of_robot_center_projection_on_X_Y_axis;
-  wheels_radius_ = wheels_radius;
+  kinematics_params_.wheels_radius = wheels_radius;
 }
 
 bool Odometry::update(const double wheel_front_left_vel,
                       const double wheel_rear_left_vel,
                       const double wheel_rear_right_vel,
-                      const double wheel_front_right_vel, const double dt) {
+                      const double wheel_front_right_vel, const double dt,
+                      const std::int64_t stamp_nanoseconds) {
   /// Compute FK (i.e. compute mobile robot's body twist out of its wheels
-  /// velocities): NOTE: the mecanum IK gives the body speed at the center
-  /// frame, we then offset this velocity
-  ///       at the base frame.
+  /// velocities), see `forward_kinematics()`.
   /// NOTE: in the diff drive the velocity is filtered out, but we prefer to
   /// return it raw and
   ///       let the user perform post-processing at will.
   ///       We prefer this way of doing as filtering introduces delay (which
   ///       makes it difficult to interpret and compare behavior curves).
+  return updateFromTwist(
+      forward_kinematics(kinematics_params_,
+                         {wheel_front_left_vel, wheel_front_right_vel,
+                          wheel_rear_right_vel, wheel_rear_left_vel}),
+      dt, stamp_nanoseconds);
+}
 
-  /// \note The variables meaning:
-  /// angular_transformation_from_center_2_base: Rotation transformation matrix,
-  /// to transform from center frame to base frame
-  /// linear_transformation_from_center_2_base: offset/linear transformation
-  /// matrix, to transform from center frame to base frame
-
-  double velocity_in_center_frame_linear_x =
-      0.25 * wheels_radius_ *
-      (wheel_front_left_vel + wheel_rear_left_vel + wheel_rear_right_vel +
-       wheel_front_right_vel);
-  double velocity_in_center_frame_linear_y =
-      0.25 * wheels_radius_ *
-      (-wheel_front_left_vel + wheel_rear_left_vel - wheel_rear_right_vel +
-       wheel_front_right_vel);
-  double velocity_in_center_frame_angular_z =
-      0.25 * wheels_radius_ / sum_of_robot_center_projection_on_X_Y_axis_ *
-      (-wheel_front_left_vel - wheel_rear_left_vel + wheel_rear_right_vel +
-       wheel_front_right_vel);
-
-  tf2::Quaternion orientation_R_c_b;
-  orientation_R_c_b.setRPY(0.0, 0.0, -base_frame_offset_[2]);
-
-  tf2::Matrix3x3 angular_transformation_from_center_2_base =
-      tf2::Matrix3x3((orientation_R_c_b));
-  tf2::Vector3 velocity_in_center_frame_w_r_t_base_frame_ =
-      angular_transformation_from_center_2_base *
-      tf2::Vector3(velocity_in_center_frame_linear_x,
-                   velocity_in_center_frame_linear_y, 0.0);
-  tf2::Vector3 linear_transformation_from_center_2_base =
-      angular_transformation_from_center_2_base *
-      tf2::Vector3(-base_frame_offset_[0], -base_frame_offset_[1], 0.0);
-
-  velocity_in_base_frame_linear_x =
-      velocity_in_center_frame_w_r_t_base_frame_.x() +
-      linear_transformation_from_center_2_base.y() *
-          velocity_in_center_frame_angular_z;
-  velocity_in_base_frame_linear_y =
-      velocity_in_center_frame_w_r_t_base_frame_.y() -
-      linear_transformation_from_center_2_base.x() *
-          velocity_in_center_frame_angular_z;
-  velocity_in_base_frame_angular_z = velocity_in_center_frame_angular_z;
-
-  tf2::Quaternion orientation_R_b_odom;
-  orientation_R_b_odom.setRPY(0.0, 0.0, orientation_z_in_base_frame_);
-  tf2::Matrix3x3 angular_transformation_from_base_2_odom =
-      tf2::Matrix3x3((orientation_R_b_odom));
-  tf2::Vector3 velocity_in_base_frame_w_r_t_odom_frame_ =
-      angular_transformation_from_base_2_odom *
-      tf2::Vector3(velocity_in_base_frame_linear_x,
-                   velocity_in_base_frame_linear_y, 0.0);
+bool Odometry::updateFromTwist(const BodyTwist &twist, const double dt,
+                               const std::int64_t stamp_nanoseconds) {
+  twist_ = twist;
 
   /// Integration.
-  /// NOTE: the position is expressed in the odometry frame , unlike the twist
-  /// which is expressed in the body frame.
-  orientation_z_in_base_frame_ += velocity_in_base_frame_angular_z * dt;
-  position_x_in_base_frame_ +=
-      velocity_in_base_frame_w_r_t_odom_frame_.x() * dt;
-  position_y_in_base_frame_ +=
-      velocity_in_base_frame_w_r_t_odom_frame_.y() * dt;
+  integrate_pose(pose_, twist_, dt);
+
+  timestamp_nanoseconds_ = stamp_nanoseconds;
+  publishSnapshot();
 
   return true;
 }
@@ -0,0 +1,50 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/process_usage.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace mecanum_drive_controller {
+ProcessUsage sample_process_usage() {
+  ProcessUsage usage;
+#if defined(__GLIBC__) &&                                                      \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  // large blocks are mapped separately
+  const auto info = mallinfo2();
+  usage.heap_bytes = static_cast<std::int64_t>(info.uordblks + info.hblkhd);
+#endif
+
+  std::FILE *status = std::fopen("/proc/self/status", "r");
+  if (status == nullptr) {
+    return usage;
+  }
+  char line[256];
+  while (std::fgets(line, sizeof(line), status) != nullptr) {
+    if (std::strncmp(line, "Threads:", 8) == 0) {
+      usage.threads = std::atoll(line + 8);
+      break;
+    }
+  }
+  std::fclose(status);
+  return usage;
+}
+
+} // namespace mecanum_drive_controller
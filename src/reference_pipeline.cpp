@@ -0,0 +1,134 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/reference_pipeline.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace { // utility
+
+using mecanum_drive_controller::BodyTwist;
+using Coefficients =
+    mecanum_drive_controller::ReferencePipeline::Coefficients;
+
+void scale(const Coefficients &c, BodyTwist &twist) {
+  twist.linear_x *= c.scale[0];
+  twist.linear_y *= c.scale[1];
+  twist.angular_z *= c.scale[2];
+}
+
+// an unlimited component has an infinite limit
+void limit(const Coefficients &c, BodyTwist &twist) {
+  twist.linear_x = std::clamp(twist.linear_x, -c.limit[0], c.limit[0]);
+  twist.linear_y = std::clamp(twist.linear_y, -c.limit[1], c.limit[1]);
+  twist.angular_z = std::clamp(twist.angular_z, -c.limit[2], c.limit[2]);
+}
+
+double deadband(const double value, const double threshold) {
+  return std::abs(value) < threshold ? 0.0 : value;
+}
+
+void deadband(const Coefficients &c, BodyTwist &twist) {
+  twist.linear_x = deadband(twist.linear_x, c.deadband[0]);
+  twist.linear_y = deadband(twist.linear_y, c.deadband[1]);
+  twist.angular_z = deadband(twist.angular_z, c.deadband[2]);
+}
+
+// twist of the reference frame to the twist of the base frame
+void frame(const Coefficients &c, BodyTwist &twist) {
+  const BodyTwist rotated{
+      c.frame_cos * twist.linear_x - c.frame_sin * twist.linear_y,
+      c.frame_sin * twist.linear_x + c.frame_cos * twist.linear_y,
+      twist.angular_z};
+  twist = mecanum_drive_controller::twist_about_point(rotated, c.frame_x,
+                                                      c.frame_y);
+}
+
+} // namespace
+
+namespace mecanum_drive_controller {
+constexpr std::size_t ReferencePipeline::MAX_STAGES;
+
+ReferencePipeline::ReferencePipeline() : size_(0) {
+  configure({}, ReferencePipelineParams());
+}
+
+bool ReferencePipeline::configure(const std::vector<std::string> &stages,
+                                  const ReferencePipelineParams &params) {
+  size_ = 0;
+  error_.clear();
+
+  coefficients_.scale = params.scale;
+  coefficients_.deadband = params.deadband;
+  for (std::size_t i = 0; i < 3; ++i) {
+    coefficients_.limit[i] = params.limit[i] > 0.0
+                                 ? params.limit[i]
+                                 : std::numeric_limits<double>::infinity();
+  }
+  coefficients_.frame_x = params.frame.x;
+  coefficients_.frame_y = params.frame.y;
+  coefficients_.frame_cos = std::cos(params.frame.rz);
+  coefficients_.frame_sin = std::sin(params.frame.rz);
+
+  std::array<bool, NR_REFERENCE_STAGES> used{};
+  for (const auto &name : stages) {
+    std::size_t kind = 0;
+    while (kind < NR_REFERENCE_STAGES &&
+           name != to_string(static_cast<ReferenceStage>(kind))) {
+      ++kind;
+    }
+    if (kind == NR_REFERENCE_STAGES) {
+      error_ = "unknown stage '" + name + "'";
+    } else if (used[kind]) {
+      error_ = "repeated stage '" + name + "'";
+    }
+    if (!error_.empty()) {
+      size_ = 0;
+      return false;
+    }
+    used[kind] = true;
+    kinds_[size_] = static_cast<ReferenceStage>(kind);
+    ++size_;
+  }
+  return true;
+}
+
+void ReferencePipeline::process(BodyTwist &twist) const {
+  for (std::size_t i = 0; i < size_; ++i) {
+    switch (kinds_[i]) {
+    case ReferenceStage::SCALE:
+      scale(coefficients_, twist);
+      break;
+    case ReferenceStage::LIMIT:
+      limit(coefficients_, twist);
+      break;
+    case ReferenceStage::DEADBAND:
+      deadband(coefficients_, twist);
+      break;
+    case ReferenceStage::FRAME:
+      frame(coefficients_, twist);
+      break;
+    }
+  }
+}
+
+const char *ReferencePipeline::to_string(const ReferenceStage stage) {
+  static constexpr const char *NAMES[] = {"scale", "limit", "deadband",
+                                          "frame"};
+  return NAMES[static_cast<std::size_t>(stage)];
+}
+
+} // namespace mecanum_drive_controller
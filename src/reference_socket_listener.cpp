@@ -0,0 +1,225 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/reference_socket_listener.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "mecanum_drive_controller/crc32.hpp"
+
+namespace { // utility
+
+constexpr std::size_t PAYLOAD_SIZE = 40;
+
+template <typename T> void put_le(std::uint8_t *data, const T value) {
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    data[i] = static_cast<std::uint8_t>(value >> (8 * i));
+  }
+}
+
+template <typename T> T get_le(const std::uint8_t *data) {
+  T value = 0;
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    value |= static_cast<T>(data[i]) << (8 * i);
+  }
+  return value;
+}
+
+void put_double(std::uint8_t *data, const double value) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  put_le(data, bits);
+}
+
+double get_double(const std::uint8_t *data) {
+  const auto bits = get_le<std::uint64_t>(data);
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+} // namespace
+
+namespace mecanum_drive_controller {
+void encode_reference_frame(
+    const ReferenceFrame &frame,
+    std::array<std::uint8_t, REFERENCE_FRAME_SIZE> &buffer) {
+  std::uint8_t *data = buffer.data();
+  put_le(data, REFERENCE_FRAME_MAGIC);
+  put_le(data + 4, frame.sequence);
+  put_le(data + 8, static_cast<std::uint64_t>(frame.stamp_nanoseconds));
+  put_double(data + 16, frame.linear_x);
+  put_double(data + 24, frame.linear_y);
+  put_double(data + 32, frame.angular_z);
+  put_le(data + 40, crc32(data, PAYLOAD_SIZE));
+  put_le(data + 44, std::uint32_t(0));
+}
+
+bool decode_reference_frame(const std::uint8_t *data, const std::size_t size,
+                            ReferenceFrame &frame) {
+  if (size != REFERENCE_FRAME_SIZE ||
+      get_le<std::uint32_t>(data) != REFERENCE_FRAME_MAGIC ||
+      get_le<std::uint32_t>(data + 40) != crc32(data, PAYLOAD_SIZE)) {
+    return false;
+  }
+  frame.sequence = get_le<std::uint32_t>(data + 4);
+  frame.stamp_nanoseconds =
+      static_cast<std::int64_t>(get_le<std::uint64_t>(data + 8));
+  frame.linear_x = get_double(data + 16);
+  frame.linear_y = get_double(data + 24);
+  frame.angular_z = get_double(data + 32);
+  return true;
+}
+
+ReferenceSocketListener::ReferenceSocketListener()
+    : fd_(-1), running_(false), has_sequence_(false), last_sequence_(0),
+      accepted_count_(0), rejected_count_(0) {}
+
+ReferenceSocketListener::~ReferenceSocketListener() { stop(); }
+
+bool ReferenceSocketListener::start(const Type type,
+                                    const std::string &unix_path,
+                                    const std::uint16_t udp_port,
+                                    Callback callback) {
+  stop();
+  error_.clear();
+
+  if (type == Type::UNIX) {
+    sockaddr_un address{};
+    if (unix_path.empty() || unix_path.size() >= sizeof(address.sun_path)) {
+      error_ = "invalid unix socket path '" + unix_path + "'";
+      return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, unix_path.c_str(),
+                 sizeof(address.sun_path) - 1);
+
+    // remove a stale socket file left by a previous instance, but never
+    // anything else a wrong path points to
+    struct stat status;
+    if (::lstat(unix_path.c_str(), &status) == 0) {
+      if (!S_ISSOCK(status.st_mode)) {
+        error_ = "'" + unix_path + "' exists and is not a socket";
+        return false;
+      }
+      ::unlink(unix_path.c_str());
+    } else if (errno != ENOENT) {
+      error_ = "stat of '" + unix_path + "' failed: " + std::strerror(errno);
+      return false;
+    }
+
+    fd_ = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ >= 0) {
+      if (::bind(fd_, reinterpret_cast<const sockaddr *>(&address),
+                 sizeof(address)) == 0) {
+        unix_path_ = unix_path;
+      } else {
+        error_ = "bind to '" + unix_path + "' failed: " + std::strerror(errno);
+      }
+    }
+  } else {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(udp_port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ >= 0 && ::bind(fd_, reinterpret_cast<const sockaddr *>(&address),
+                           sizeof(address)) != 0) {
+      error_ = "bind to 127.0.0.1:" + std::to_string(udp_port) +
+               " failed: " + std::strerror(errno);
+    }
+  }
+
+  if (fd_ < 0) {
+    error_ = std::string("socket creation failed: ") + std::strerror(errno);
+    return false;
+  }
+  if (!error_.empty()) {
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+
+  callback_ = std::move(callback);
+  has_sequence_ = false;
+  running_ = true;
+  thread_ = std::thread(&ReferenceSocketListener::run, this);
+  return true;
+}
+
+void ReferenceSocketListener::stop() {
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  if (!unix_path_.empty()) {
+    ::unlink(unix_path_.c_str());
+    unix_path_.clear();
+  }
+}
+
+void ReferenceSocketListener::run() {
+  // one byte more than a frame so oversized datagrams are detected
+  std::array<std::uint8_t, REFERENCE_FRAME_SIZE + 1> buffer;
+  pollfd descriptor{fd_, POLLIN, 0};
+  constexpr int POLL_TIMEOUT_MS = 100;
+
+  while (running_) {
+    if (::poll(&descriptor, 1, POLL_TIMEOUT_MS) <= 0) {
+      continue;
+    }
+    const auto size = ::recv(fd_, buffer.data(), buffer.size(), 0);
+    if (size < 0) {
+      continue;
+    }
+
+    ReferenceFrame frame;
+    if (!decode_reference_frame(buffer.data(), static_cast<std::size_t>(size),
+                                frame)) {
+      rejected_count_.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+
+    // wrap-around safe "is newer" check
+    const bool is_newer =
+        !has_sequence_ || frame.sequence == 0 ||
+        static_cast<std::int32_t>(frame.sequence - last_sequence_) > 0;
+    if (!is_newer) {
+      rejected_count_.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    has_sequence_ = true;
+    last_sequence_ = frame.sequence;
+    accepted_count_.fetch_add(1, std::memory_order_relaxed);
+
+    callback_(frame);
+  }
+}
+
+} // namespace mecanum_drive_controller
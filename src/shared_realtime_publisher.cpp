@@ -0,0 +1,81 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/shared_realtime_publisher.hpp"
+
+#include <algorithm>
+
+namespace mecanum_drive_controller {
+bool PublishSlot::publish_pending() {
+  int expected = PENDING;
+  if (!state_.compare_exchange_strong(expected, LOCKED,
+                                      std::memory_order_acquire)) {
+    return false;
+  }
+  publish_message();
+  release(FREE);
+  return true;
+}
+
+std::shared_ptr<SharedPublisherThread> SharedPublisherThread::acquire() {
+  static std::mutex instance_mutex;
+  static std::weak_ptr<SharedPublisherThread> instance;
+
+  std::lock_guard<std::mutex> lock(instance_mutex);
+  auto thread = instance.lock();
+  if (!thread) {
+    thread.reset(new SharedPublisherThread());
+    instance = thread;
+  }
+  return thread;
+}
+
+SharedPublisherThread::SharedPublisherThread() : running_(true) {
+  thread_ = std::thread(&SharedPublisherThread::run, this);
+}
+
+SharedPublisherThread::~SharedPublisherThread() {
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void SharedPublisherThread::add(PublishSlot *slot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  slots_.push_back(slot);
+}
+
+void SharedPublisherThread::remove(PublishSlot *slot) {
+  // taken between two sweeps, the slot is not published meanwhile
+  std::lock_guard<std::mutex> lock(mutex_);
+  slots_.erase(std::remove(slots_.begin(), slots_.end(), slot), slots_.end());
+}
+
+void SharedPublisherThread::run() {
+  // the RT thread is not allowed to signal, so the slots are polled at the
+  // period of `realtime_tools::RealtimePublisher`
+  constexpr auto POLL_PERIOD = std::chrono::microseconds(500);
+  while (running_.load()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto *slot : slots_) {
+        slot->publish_pending();
+      }
+    }
+    std::this_thread::sleep_for(POLL_PERIOD);
+  }
+}
+
+} // namespace mecanum_drive_controller
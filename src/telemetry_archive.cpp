@@ -0,0 +1,514 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/telemetry_archive.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "mecanum_drive_controller/crc32.hpp"
+
+namespace { // utility
+
+constexpr std::uint32_t FILE_MAGIC = 0x4154444d;  // "MDTA"
+constexpr std::uint32_t BLOCK_MAGIC = 0x4254444d; // "MDTB"
+constexpr std::uint32_t INDEX_MAGIC = 0x4954444d; // "MDTI"
+constexpr std::uint32_t END_MAGIC = 0x4554444d;   // "MDTE"
+constexpr std::uint32_t FORMAT_VERSION = 1;
+
+constexpr std::size_t FILE_HEADER_SIZE =
+    16 + 8 * mecanum_drive_controller::NR_TELEMETRY_CHANNELS;
+constexpr std::size_t BLOCK_HEADER_SIZE = 32;
+constexpr std::size_t INDEX_ENTRY_SIZE = 32;
+constexpr std::size_t TRAILER_SIZE = 16;
+
+// values beyond this are not representable after quantization
+constexpr double MAX_QUANTIZED = 9.0e15;
+
+const char *CHANNEL_NAMES[mecanum_drive_controller::NR_TELEMETRY_CHANNELS] = {
+    "front_left_state",    "front_right_state",   "rear_right_state",
+    "rear_left_state",     "front_left_command",  "front_right_command",
+    "rear_right_command",  "rear_left_command",   "odometry_x",
+    "odometry_y",          "odometry_rz",         "odometry_vx",
+    "odometry_vy",         "odometry_wz"};
+
+template <typename T> void put_le(std::uint8_t *data, const T value) {
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    data[i] = static_cast<std::uint8_t>(value >> (8 * i));
+  }
+}
+
+template <typename T> T get_le(const std::uint8_t *data) {
+  T value = 0;
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    value |= static_cast<T>(data[i]) << (8 * i);
+  }
+  return value;
+}
+
+void put_varint(std::vector<std::uint8_t> &buffer, std::uint64_t value) {
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<std::uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<std::uint8_t>(value));
+}
+
+bool get_varint(const std::uint8_t *&data, const std::uint8_t *end,
+                std::uint64_t &value) {
+  value = 0;
+  for (unsigned shift = 0; shift < 64 && data < end; shift += 7) {
+    const std::uint8_t byte = *data++;
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::uint64_t zigzag(const std::int64_t value) {
+  return (static_cast<std::uint64_t>(value) << 1) ^
+         static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(const std::uint64_t value) {
+  return static_cast<std::int64_t>(value >> 1) ^
+         -static_cast<std::int64_t>(value & 1);
+}
+
+void decode_block_header(const std::uint8_t *data,
+                         mecanum_drive_controller::TelemetryBlockInfo &block,
+                         std::uint32_t &payload_size, std::uint32_t &crc) {
+  block.sample_count = get_le<std::uint32_t>(data + 4);
+  block.first_stamp_nanoseconds =
+      static_cast<std::int64_t>(get_le<std::uint64_t>(data + 8));
+  block.last_stamp_nanoseconds =
+      static_cast<std::int64_t>(get_le<std::uint64_t>(data + 16));
+  payload_size = get_le<std::uint32_t>(data + 24);
+  crc = get_le<std::uint32_t>(data + 28);
+}
+
+} // namespace
+
+namespace mecanum_drive_controller {
+const char *telemetry_channel_name(const std::size_t channel) {
+  return channel < NR_TELEMETRY_CHANNELS ? CHANNEL_NAMES[channel] : "unknown";
+}
+
+TelemetryQuantization default_telemetry_quantization() {
+  TelemetryQuantization quantization;
+  std::fill_n(quantization.begin(), ODOMETRY_X, 1e-4);
+  quantization[ODOMETRY_X] = 1e-5;
+  quantization[ODOMETRY_Y] = 1e-5;
+  quantization[ODOMETRY_RZ] = 1e-6;
+  quantization[ODOMETRY_VX] = 1e-4;
+  quantization[ODOMETRY_VY] = 1e-4;
+  quantization[ODOMETRY_WZ] = 1e-4;
+  return quantization;
+}
+
+TelemetryArchiveWriter::TelemetryArchiveWriter()
+    : quantization_(default_telemetry_quantization()), block_samples_(1),
+      previous_stamp_(0), previous_stamp_delta_(0) {
+  previous_values_.fill(0);
+}
+
+TelemetryArchiveWriter::~TelemetryArchiveWriter() { close(); }
+
+bool TelemetryArchiveWriter::open(const std::string &path,
+                                  const TelemetryQuantization &quantization,
+                                  const std::size_t block_samples) {
+  close();
+  error_.clear();
+  quantization_ = quantization;
+  block_samples_ = std::max<std::size_t>(block_samples, 1);
+  index_.clear();
+  block_ = TelemetryBlockInfo();
+  payload_.clear();
+  payload_.reserve(block_samples_ * (4 + 3 * NR_TELEMETRY_CHANNELS));
+
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_) {
+    error_ = "cannot create '" + path + "'";
+    return false;
+  }
+
+  std::uint8_t header[FILE_HEADER_SIZE] = {};
+  put_le(header, FILE_MAGIC);
+  put_le(header + 4, FORMAT_VERSION);
+  put_le(header + 8, static_cast<std::uint32_t>(NR_TELEMETRY_CHANNELS));
+  for (std::size_t i = 0; i < NR_TELEMETRY_CHANNELS; ++i) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &quantization_[i], sizeof(bits));
+    put_le(header + 16 + 8 * i, bits);
+  }
+  file_.write(reinterpret_cast<const char *>(header), sizeof(header));
+  if (!file_) {
+    error_ = "cannot write header to '" + path + "'";
+    file_.close();
+    return false;
+  }
+  return true;
+}
+
+void TelemetryArchiveWriter::start_block() {
+  payload_.clear();
+  block_ = TelemetryBlockInfo();
+  block_.offset = static_cast<std::uint64_t>(file_.tellp());
+  previous_stamp_delta_ = 0;
+  previous_values_.fill(0);
+}
+
+bool TelemetryArchiveWriter::append(const TelemetrySample &sample) {
+  if (!file_.is_open()) {
+    return false;
+  }
+  if (block_.sample_count == 0) {
+    start_block();
+    block_.first_stamp_nanoseconds = sample.stamp_nanoseconds;
+    previous_stamp_ = sample.stamp_nanoseconds;
+  }
+
+  const std::int64_t stamp_delta = sample.stamp_nanoseconds - previous_stamp_;
+  put_varint(payload_, zigzag(stamp_delta - previous_stamp_delta_));
+  previous_stamp_ = sample.stamp_nanoseconds;
+  previous_stamp_delta_ = stamp_delta;
+
+  std::array<std::int64_t, NR_TELEMETRY_CHANNELS> values;
+  std::uint64_t nan_mask = 0;
+  for (std::size_t i = 0; i < NR_TELEMETRY_CHANNELS; ++i) {
+    const double scaled = sample.values[i] / quantization_[i];
+    if (std::isfinite(scaled) && std::abs(scaled) < MAX_QUANTIZED) {
+      values[i] = std::llround(scaled);
+    } else {
+      // non-finite values are stored as NaN, the delta chain is kept
+      nan_mask |= std::uint64_t(1) << i;
+      values[i] = previous_values_[i];
+    }
+  }
+  put_varint(payload_, nan_mask);
+  for (std::size_t i = 0; i < NR_TELEMETRY_CHANNELS; ++i) {
+    put_varint(payload_, zigzag(values[i] - previous_values_[i]));
+  }
+  previous_values_ = values;
+
+  block_.last_stamp_nanoseconds = sample.stamp_nanoseconds;
+  if (++block_.sample_count >= block_samples_) {
+    return flush();
+  }
+  return true;
+}
+
+bool TelemetryArchiveWriter::flush() {
+  if (!file_.is_open() || block_.sample_count == 0) {
+    return file_.is_open();
+  }
+
+  std::uint8_t header[BLOCK_HEADER_SIZE];
+  put_le(header, BLOCK_MAGIC);
+  put_le(header + 4, block_.sample_count);
+  put_le(header + 8,
+         static_cast<std::uint64_t>(block_.first_stamp_nanoseconds));
+  put_le(header + 16,
+         static_cast<std::uint64_t>(block_.last_stamp_nanoseconds));
+  put_le(header + 24, static_cast<std::uint32_t>(payload_.size()));
+  put_le(header + 28, crc32(payload_.data(), payload_.size()));
+  file_.write(reinterpret_cast<const char *>(header), sizeof(header));
+  file_.write(reinterpret_cast<const char *>(payload_.data()),
+              static_cast<std::streamsize>(payload_.size()));
+  // hand the block to the OS, so a crash of the process only loses the
+  // pending samples. Without an fsync a power loss can lose more.
+  file_.flush();
+
+  index_.push_back(block_);
+  block_.sample_count = 0;
+  if (!file_) {
+    error_ = "cannot write block";
+    return false;
+  }
+  return true;
+}
+
+bool TelemetryArchiveWriter::close() {
+  if (!file_.is_open()) {
+    return true;
+  }
+  bool ok = flush();
+
+  const auto index_offset = static_cast<std::uint64_t>(file_.tellp());
+  std::vector<std::uint8_t> index(8 + INDEX_ENTRY_SIZE * index_.size() +
+                                  TRAILER_SIZE);
+  put_le(index.data(), INDEX_MAGIC);
+  put_le(index.data() + 4, static_cast<std::uint32_t>(index_.size()));
+  std::uint8_t *entry = index.data() + 8;
+  for (const auto &block : index_) {
+    put_le(entry, block.offset);
+    put_le(entry + 8,
+           static_cast<std::uint64_t>(block.first_stamp_nanoseconds));
+    put_le(entry + 16,
+           static_cast<std::uint64_t>(block.last_stamp_nanoseconds));
+    put_le(entry + 24, block.sample_count);
+    put_le(entry + 28, std::uint32_t(0));
+    entry += INDEX_ENTRY_SIZE;
+  }
+  put_le(entry, index_offset);
+  put_le(entry + 8, END_MAGIC);
+  put_le(entry + 12, std::uint32_t(0));
+  file_.write(reinterpret_cast<const char *>(index.data()),
+              static_cast<std::streamsize>(index.size()));
+
+  ok = ok && static_cast<bool>(file_);
+  if (!ok && error_.empty()) {
+    error_ = "cannot write block index";
+  }
+  file_.close();
+  return ok;
+}
+
+bool TelemetryArchiveReader::open(const std::string &path) {
+  file_.close();
+  file_.clear();
+  error_.clear();
+  blocks_.clear();
+  has_index_ = false;
+  corrupted_block_count_ = 0;
+
+  file_.open(path, std::ios::binary);
+  if (!file_) {
+    error_ = "cannot open '" + path + "'";
+    return false;
+  }
+  file_.seekg(0, std::ios::end);
+  const auto file_size = static_cast<std::uint64_t>(file_.tellg());
+  file_.seekg(0);
+
+  std::uint8_t header[FILE_HEADER_SIZE];
+  if (file_size < FILE_HEADER_SIZE ||
+      !file_.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+      get_le<std::uint32_t>(header) != FILE_MAGIC) {
+    error_ = "'" + path + "' is no telemetry archive";
+    return false;
+  }
+  if (get_le<std::uint32_t>(header + 4) != FORMAT_VERSION ||
+      get_le<std::uint32_t>(header + 8) != NR_TELEMETRY_CHANNELS) {
+    error_ = "'" + path + "' has an unsupported format version";
+    return false;
+  }
+  for (std::size_t i = 0; i < NR_TELEMETRY_CHANNELS; ++i) {
+    const auto bits = get_le<std::uint64_t>(header + 16 + 8 * i);
+    std::memcpy(&quantization_[i], &bits, sizeof(bits));
+  }
+  data_offset_ = FILE_HEADER_SIZE;
+
+  has_index_ = read_index(file_size);
+  if (!has_index_) {
+    scan_blocks(file_size);
+  }
+  file_.clear();
+  return true;
+}
+
+bool TelemetryArchiveReader::read_index(const std::uint64_t file_size) {
+  if (file_size < data_offset_ + 8 + TRAILER_SIZE) {
+    return false;
+  }
+  std::uint8_t trailer[TRAILER_SIZE];
+  file_.seekg(static_cast<std::streamoff>(file_size - TRAILER_SIZE));
+  if (!file_.read(reinterpret_cast<char *>(trailer), sizeof(trailer)) ||
+      get_le<std::uint32_t>(trailer + 8) != END_MAGIC) {
+    return false;
+  }
+  const auto index_offset = get_le<std::uint64_t>(trailer);
+  if (index_offset < data_offset_ ||
+      index_offset + 8 + TRAILER_SIZE > file_size) {
+    return false;
+  }
+
+  std::vector<std::uint8_t> index(
+      static_cast<std::size_t>(file_size - TRAILER_SIZE - index_offset));
+  file_.seekg(static_cast<std::streamoff>(index_offset));
+  if (!file_.read(reinterpret_cast<char *>(index.data()),
+                  static_cast<std::streamsize>(index.size())) ||
+      get_le<std::uint32_t>(index.data()) != INDEX_MAGIC) {
+    return false;
+  }
+  const std::size_t count = get_le<std::uint32_t>(index.data() + 4);
+  if (8 + count * INDEX_ENTRY_SIZE != index.size()) {
+    return false;
+  }
+
+  blocks_.resize(count);
+  const std::uint8_t *entry = index.data() + 8;
+  for (auto &block : blocks_) {
+    block.offset = get_le<std::uint64_t>(entry);
+    block.first_stamp_nanoseconds =
+        static_cast<std::int64_t>(get_le<std::uint64_t>(entry + 8));
+    block.last_stamp_nanoseconds =
+        static_cast<std::int64_t>(get_le<std::uint64_t>(entry + 16));
+    block.sample_count = get_le<std::uint32_t>(entry + 24);
+    entry += INDEX_ENTRY_SIZE;
+  }
+  return true;
+}
+
+void TelemetryArchiveReader::scan_blocks(const std::uint64_t file_size) {
+  blocks_.clear();
+  std::uint64_t offset = data_offset_;
+  std::uint8_t header[BLOCK_HEADER_SIZE];
+  std::vector<std::uint8_t> payload;
+  // blocks failed since the last valid one, counted once another valid
+  // block shows that they were not just cut off at the end
+  std::size_t failed_count = 0;
+  bool is_cut_off = false;
+  while (offset + BLOCK_HEADER_SIZE <= file_size) {
+    TelemetryBlockInfo block;
+    std::uint32_t payload_size = 0;
+    std::uint32_t crc = 0;
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(offset));
+    bool is_valid =
+        file_.read(reinterpret_cast<char *>(header), sizeof(header)) &&
+        get_le<std::uint32_t>(header) == BLOCK_MAGIC;
+    is_cut_off = false;
+    if (is_valid) {
+      decode_block_header(header, block, payload_size, crc);
+      is_valid = offset + BLOCK_HEADER_SIZE + payload_size <= file_size;
+      is_cut_off = !is_valid;
+    }
+    if (is_valid) {
+      // the CRC also catches a corrupted payload size
+      payload.resize(payload_size);
+      is_valid = file_.read(reinterpret_cast<char *>(payload.data()),
+                            payload_size) &&
+                 crc32(payload.data(), payload.size()) == crc;
+    }
+    if (!is_valid) {
+      // continue at the next block magic
+      ++failed_count;
+      offset = find_block_magic(offset + 1, file_size);
+      continue;
+    }
+    corrupted_block_count_ += failed_count;
+    failed_count = 0;
+    block.offset = offset;
+    blocks_.push_back(block);
+    offset += BLOCK_HEADER_SIZE + payload_size;
+  }
+  // the last block of a crashed writer is cut off, not corrupted
+  corrupted_block_count_ += failed_count - (is_cut_off ? 1 : 0);
+}
+
+std::uint64_t
+TelemetryArchiveReader::find_block_magic(std::uint64_t offset,
+                                         const std::uint64_t file_size) {
+  std::uint8_t chunk[4096];
+  while (offset + sizeof(BLOCK_MAGIC) <= file_size) {
+    const auto size = static_cast<std::size_t>(
+        std::min<std::uint64_t>(sizeof(chunk), file_size - offset));
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(offset));
+    if (!file_.read(reinterpret_cast<char *>(chunk),
+                    static_cast<std::streamsize>(size))) {
+      break;
+    }
+    for (std::size_t i = 0; i + sizeof(BLOCK_MAGIC) <= size; ++i) {
+      if (get_le<std::uint32_t>(chunk + i) == BLOCK_MAGIC) {
+        return offset + i;
+      }
+    }
+    // chunks overlap, so a magic across their border is found
+    offset += size - (sizeof(BLOCK_MAGIC) - 1);
+  }
+  return file_size;
+}
+
+bool TelemetryArchiveReader::read(
+    const std::int64_t begin_nanoseconds, const std::int64_t end_nanoseconds,
+    const std::function<void(const TelemetrySample &)> &callback) {
+  if (!file_.is_open()) {
+    return false;
+  }
+
+  std::vector<std::uint8_t> payload;
+  std::uint8_t header[BLOCK_HEADER_SIZE];
+  for (const auto &block : blocks_) {
+    if (block.last_stamp_nanoseconds < begin_nanoseconds) {
+      continue;
+    }
+    if (block.first_stamp_nanoseconds > end_nanoseconds) {
+      break;
+    }
+
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(block.offset));
+    if (!file_.read(reinterpret_cast<char *>(header), sizeof(header))) {
+      error_ = "cannot read block header";
+      return false;
+    }
+    TelemetryBlockInfo info;
+    std::uint32_t payload_size;
+    std::uint32_t crc;
+    decode_block_header(header, info, payload_size, crc);
+    payload.resize(payload_size);
+    if (!file_.read(reinterpret_cast<char *>(payload.data()), payload_size)) {
+      error_ = "cannot read block payload";
+      return false;
+    }
+    if (get_le<std::uint32_t>(header) != BLOCK_MAGIC ||
+        crc32(payload.data(), payload.size()) != crc) {
+      ++corrupted_block_count_;
+      continue;
+    }
+
+    const std::uint8_t *data = payload.data();
+    const std::uint8_t *end = data + payload.size();
+    TelemetrySample sample;
+    std::int64_t stamp = info.first_stamp_nanoseconds;
+    std::int64_t stamp_delta = 0;
+    std::array<std::int64_t, NR_TELEMETRY_CHANNELS> values{};
+    for (std::uint32_t n = 0; n < info.sample_count; ++n) {
+      std::uint64_t raw;
+      std::uint64_t nan_mask;
+      if (!get_varint(data, end, raw)) {
+        ++corrupted_block_count_;
+        break;
+      }
+      stamp_delta += unzigzag(raw);
+      stamp += stamp_delta;
+      bool ok = get_varint(data, end, nan_mask);
+      for (std::size_t i = 0; ok && i < NR_TELEMETRY_CHANNELS; ++i) {
+        ok = get_varint(data, end, raw);
+        values[i] += unzigzag(raw);
+        sample.values[i] = (nan_mask >> i) & 1u
+                               ? std::numeric_limits<double>::quiet_NaN()
+                               : static_cast<double>(values[i]) *
+                                     quantization_[i];
+      }
+      if (!ok) {
+        ++corrupted_block_count_;
+        break;
+      }
+      sample.stamp_nanoseconds = stamp;
+      if (stamp >= begin_nanoseconds && stamp <= end_nanoseconds) {
+        callback(sample);
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace mecanum_drive_controller
@@ -0,0 +1,107 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Prints (a time range of) a telemetry archive as CSV.
+//
+// usage: telemetry_archive_dump <archive> [<begin [s]> [<end [s]>]]
+//        telemetry_archive_dump --info <archive>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "mecanum_drive_controller/telemetry_archive.hpp"
+
+using mecanum_drive_controller::NR_TELEMETRY_CHANNELS;
+using mecanum_drive_controller::TelemetryArchiveReader;
+using mecanum_drive_controller::TelemetrySample;
+
+namespace {
+std::int64_t seconds_to_nanoseconds(const char *seconds) {
+  return static_cast<std::int64_t>(std::strtod(seconds, nullptr) * 1e9);
+}
+
+int print_usage(const char *program) {
+  std::fprintf(stderr,
+               "usage: %s <archive> [<begin [s]> [<end [s]>]]\n"
+               "       %s --info <archive>\n",
+               program, program);
+  return EXIT_FAILURE;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    return print_usage(argv[0]);
+  }
+  const bool info = std::strcmp(argv[1], "--info") == 0;
+  if (info && argc != 3) {
+    return print_usage(argv[0]);
+  }
+
+  TelemetryArchiveReader reader;
+  if (!reader.open(argv[info ? 2 : 1])) {
+    std::fprintf(stderr, "%s\n", reader.error().c_str());
+    return EXIT_FAILURE;
+  }
+
+  if (info) {
+    std::size_t samples = 0;
+    for (const auto &block : reader.blocks()) {
+      samples += block.sample_count;
+    }
+    std::printf("blocks: %zu\nsamples: %zu\nindexed: %s\n",
+                reader.blocks().size(), samples,
+                reader.has_index() ? "yes" : "no (recovered by scanning)");
+    if (!reader.blocks().empty()) {
+      std::printf("first stamp [ns]: %" PRId64 "\nlast stamp [ns]: %" PRId64
+                  "\n",
+                  reader.blocks().front().first_stamp_nanoseconds,
+                  reader.blocks().back().last_stamp_nanoseconds);
+    }
+    return EXIT_SUCCESS;
+  }
+
+  const std::int64_t begin = argc > 2
+                                 ? seconds_to_nanoseconds(argv[2])
+                                 : std::numeric_limits<std::int64_t>::min();
+  const std::int64_t end = argc > 3 ? seconds_to_nanoseconds(argv[3])
+                                    : std::numeric_limits<std::int64_t>::max();
+
+  std::printf("stamp_ns");
+  for (std::size_t i = 0; i < NR_TELEMETRY_CHANNELS; ++i) {
+    std::printf(",%s", mecanum_drive_controller::telemetry_channel_name(i));
+  }
+  std::printf("\n");
+
+  const bool ok = reader.read(begin, end, [](const TelemetrySample &sample) {
+    std::printf("%" PRId64, sample.stamp_nanoseconds);
+    for (const double value : sample.values) {
+      std::printf(",%.9g", value);
+    }
+    std::printf("\n");
+  });
+  if (reader.corrupted_block_count() > 0) {
+    std::fprintf(stderr, "skipped %zu corrupted block(s)\n",
+                 reader.corrupted_block_count());
+  }
+  if (!ok) {
+    std::fprintf(stderr, "%s\n", reader.error().c_str());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
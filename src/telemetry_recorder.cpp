@@ -0,0 +1,74 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/telemetry_recorder.hpp"
+
+#include <chrono>
+
+namespace mecanum_drive_controller {
+TelemetryRecorder::TelemetryRecorder() : running_(false), dropped_count_(0) {}
+
+TelemetryRecorder::~TelemetryRecorder() { stop(); }
+
+bool TelemetryRecorder::start(const std::string &path,
+                              const std::size_t queue_size,
+                              const std::size_t block_samples) {
+  stop();
+  error_.clear();
+  if (!writer_.open(path, default_telemetry_quantization(), block_samples)) {
+    error_ = writer_.error();
+    return false;
+  }
+  queue_ = std::make_unique<SpscQueue<TelemetrySample>>(queue_size);
+  running_ = true;
+  thread_ = std::thread(&TelemetryRecorder::run, this);
+  return true;
+}
+
+void TelemetryRecorder::stop() {
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  writer_.close();
+}
+
+bool TelemetryRecorder::record(const TelemetrySample &sample) {
+  if (!running_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  if (!queue_->push(sample)) {
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void TelemetryRecorder::run() {
+  // the RT thread is not allowed to signal, so the queue is polled
+  constexpr auto POLL_PERIOD = std::chrono::milliseconds(10);
+  TelemetrySample sample;
+  bool stopping = false;
+  while (!stopping) {
+    stopping = !running_.load();
+    while (queue_->pop(sample)) {
+      writer_.append(sample);
+    }
+    if (!stopping) {
+      std::this_thread::sleep_for(POLL_PERIOD);
+    }
+  }
+}
+
+} // namespace mecanum_drive_controller
@@ -0,0 +1,88 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/wheel_velocity_estimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mecanum_drive_controller {
+WheelVelocityEstimator::WheelVelocityEstimator()
+    : min_window_(1), max_window_(1), min_displacement_(0.0) {}
+
+void WheelVelocityEstimator::configure(const std::size_t min_window,
+                                       const std::size_t max_window,
+                                       const double min_displacement) {
+  max_window_ = std::min(std::max<std::size_t>(max_window, 1), MAX_WINDOW);
+  min_window_ = std::min(std::max<std::size_t>(min_window, 1), max_window_);
+  min_displacement_ = min_displacement;
+  reset();
+}
+
+void WheelVelocityEstimator::reset() {
+  for (auto &wheel : wheels_) {
+    wheel.head = 0;
+    wheel.count = 0;
+    wheel.time = 0.0;
+    wheel.window = 0;
+  }
+}
+
+double WheelVelocityEstimator::update(const std::size_t wheel_index,
+                                      const double position, const double dt) {
+  Wheel &wheel = wheels_[wheel_index];
+  if (std::isnan(position)) {
+    wheel.count = 0;
+    wheel.window = 0;
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+
+  wheel.head = (wheel.head + 1) % BUFFER_SIZE;
+  wheel.time += dt;
+  wheel.positions[wheel.head] = position;
+  wheel.times[wheel.head] = wheel.time;
+  wheel.count = std::min(wheel.count + 1, BUFFER_SIZE);
+  if (wheel.count < 2) {
+    wheel.window = 0;
+    return 0.0;
+  }
+
+  // the longest available window tells how fast the wheel roughly is
+  const std::size_t longest = std::min(max_window_, wheel.count - 1);
+  const double long_displacement =
+      position - wheel.positions[at(wheel, longest)];
+
+  std::size_t window = longest;
+  if (long_displacement != 0.0 &&
+      std::abs(long_displacement) >= min_displacement_) {
+    // shortest window still containing `min_displacement_` at that speed
+    const double samples_needed = min_displacement_ *
+                                  static_cast<double>(longest) /
+                                  std::abs(long_displacement);
+    window = std::min(
+        std::max(static_cast<std::size_t>(std::ceil(samples_needed)),
+                 min_window_),
+        longest);
+  }
+  wheel.window = window;
+
+  const double duration = wheel.time - wheel.times[at(wheel, window)];
+  if (duration <= 0.0) {
+    return 0.0;
+  }
+  return (position - wheel.positions[at(wheel, window)]) / duration;
+}
+
+} // namespace mecanum_drive_controller
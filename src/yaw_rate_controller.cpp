@@ -0,0 +1,57 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mecanum_drive_controller/yaw_rate_controller.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mecanum_drive_controller {
+YawRateController::YawRateController() { configure(0.0, 0.0, 0.0); }
+
+void YawRateController::configure(const double kp, const double ki,
+                                  const double max_correction) {
+  kp_ = kp;
+  ki_ = ki;
+  max_correction_ = max_correction > 0.0
+                        ? max_correction
+                        : std::numeric_limits<double>::infinity();
+  reset();
+}
+
+void YawRateController::reset() {
+  integral_ = 0.0;
+  correction_ = 0.0;
+}
+
+double YawRateController::update(const double commanded,
+                                 const double measured, const double dt) {
+  if (std::isnan(measured) || std::isnan(commanded)) {
+    correction_ = 0.0;
+    return commanded;
+  }
+
+  const double error = commanded - measured;
+  if (ki_ > 0.0 && dt > 0.0) {
+    // the integral alone never exceeds the correction limit
+    const double max_integral = max_correction_ / ki_;
+    integral_ = std::clamp(integral_ + error * dt, -max_integral, max_integral);
+  }
+  correction_ = std::clamp(kp_ * error + ki_ * integral_, -max_correction_,
+                           max_correction_);
+  return commanded + correction_;
+}
+
+} // namespace mecanum_drive_controller
@@ -0,0 +1,338 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Scale benchmark of the controller under controller_manager: loads,
+// configures and activates many controller instances, each driving its own
+// mock hardware base, and reports per instance count
+//  - the time to load, configure and activate all instances,
+//  - the memory (heap in use and resident set) and threads added per
+//    instance, measured around the whole process,
+//  - the controller_manager read/update/write cycle time.
+// Every instance count runs in a fresh controller_manager; the memory of a
+// previous run may be reused, so later runs can report less.
+//
+// Usage: benchmark_controller_scale [--instances n[,n...]] [--cycles n]
+
+#include <dirent.h>
+#include <malloc.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controller_manager/controller_manager.hpp"
+#include "controller_manager_msgs/srv/switch_controller.hpp"
+#include "rclcpp/executors/single_threaded_executor.hpp"
+#include "rclcpp/utilities.hpp"
+
+namespace { // utility
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const char *CONTROLLER_TYPE =
+    "mecanum_drive_controller/MecanumDriveController";
+constexpr const char *WHEELS[] = {"front_left", "front_right", "rear_right",
+                                  "rear_left"};
+
+struct Options {
+  std::vector<std::size_t> instances = {50, 100, 200, 500};
+  std::size_t cycles = 1000;
+};
+
+struct Usage {
+  std::int64_t heap_bytes = 0;
+  std::int64_t resident_bytes = 0;
+  std::int64_t threads = 0;
+};
+
+std::string base_name(const std::size_t instance) {
+  return "base_" + std::to_string(instance);
+}
+
+std::string controller_name(const std::size_t instance) {
+  return "mecanum_" + std::to_string(instance);
+}
+
+std::string joint_name(const std::size_t instance, const char *wheel) {
+  return base_name(instance) + "_" + wheel + "_wheel_joint";
+}
+
+// a base link and four continuous wheel joints per instance, each base is a
+// mock system of its own
+std::string make_urdf(const std::size_t nr_instances) {
+  std::ostringstream urdf;
+  urdf << "<?xml version=\"1.0\"?>\n<robot name=\"scale\">\n"
+       << "  <link name=\"world\"/>\n";
+  for (std::size_t i = 0; i < nr_instances; ++i) {
+    const auto base = base_name(i);
+    urdf << "  <link name=\"" << base << "_link\"/>\n"
+         << "  <joint name=\"" << base << "_joint\" type=\"fixed\">\n"
+         << "    <parent link=\"world\"/><child link=\"" << base
+         << "_link\"/>\n  </joint>\n";
+    for (const char *wheel : WHEELS) {
+      const auto joint = joint_name(i, wheel);
+      urdf << "  <link name=\"" << joint << "_link\"/>\n"
+           << "  <joint name=\"" << joint << "\" type=\"continuous\">\n"
+           << "    <parent link=\"" << base << "_link\"/><child link=\""
+           << joint << "_link\"/>\n    <axis xyz=\"0 1 0\"/>\n  </joint>\n";
+    }
+  }
+  for (std::size_t i = 0; i < nr_instances; ++i) {
+    urdf << "  <ros2_control name=\"" << base_name(i)
+         << "\" type=\"system\">\n"
+         << "    <hardware>\n"
+         << "      <plugin>mock_components/GenericSystem</plugin>\n"
+         << "      <param name=\"calculate_dynamics\">true</param>\n"
+         << "    </hardware>\n";
+    for (const char *wheel : WHEELS) {
+      urdf << "    <joint name=\"" << joint_name(i, wheel) << "\">\n"
+           << "      <command_interface name=\"velocity\"/>\n"
+           << "      <state_interface name=\"position\"/>\n"
+           << "      <state_interface name=\"velocity\"/>\n"
+           << "    </joint>\n";
+    }
+    urdf << "  </ros2_control>\n";
+  }
+  urdf << "</robot>\n";
+  return urdf.str();
+}
+
+// the controller nodes read their parameters from a global parameter file
+bool write_parameters(const std::string &path, const std::size_t nr_instances) {
+  std::ofstream file(path);
+  for (std::size_t i = 0; i < nr_instances; ++i) {
+    file << controller_name(i) << ":\n  ros__parameters:\n"
+         << "    reference_timeout: 0.1\n";
+    for (const char *wheel : WHEELS) {
+      file << "    " << wheel << "_wheel_command_joint_name: \""
+           << joint_name(i, wheel) << "\"\n";
+    }
+    file << "    kinematics:\n"
+         << "      base_frame_offset: { x: 0.0, y: 0.0, theta: 0.0 }\n"
+         << "      wheels_radius: 0.05\n"
+         << "      sum_of_robot_center_projection_on_X_Y_axis: 0.5\n"
+         << "    base_frame_id: \"" << base_name(i) << "/base_link\"\n"
+         << "    odom_frame_id: \"" << base_name(i) << "/odom\"\n";
+  }
+  return static_cast<bool>(file);
+}
+
+std::int64_t count_threads() {
+  DIR *directory = opendir("/proc/self/task");
+  if (directory == nullptr) {
+    return 0;
+  }
+  std::int64_t threads = 0;
+  while (const dirent *entry = readdir(directory)) {
+    threads += entry->d_name[0] != '.' ? 1 : 0;
+  }
+  closedir(directory);
+  return threads;
+}
+
+std::int64_t resident_bytes() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmRSS:") == 0) {
+      return 1024 * std::atoll(line.c_str() + 6);
+    }
+  }
+  return 0;
+}
+
+Usage measure_usage() {
+  Usage usage;
+  const auto info = mallinfo2();
+  usage.heap_bytes = static_cast<std::int64_t>(info.uordblks + info.hblkhd);
+  usage.resident_bytes = resident_bytes();
+  usage.threads = count_threads();
+  return usage;
+}
+
+double seconds_since(const Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/// \return false if an instance fails to load, configure or activate
+bool run(const std::string &urdf, const std::size_t nr_instances,
+         const std::size_t nr_cycles) {
+  const Usage before = measure_usage();
+  const auto load_start = Clock::now();
+
+  auto executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto cm = std::make_shared<controller_manager::ControllerManager>(
+      executor, urdf, true, "controller_manager");
+  const double hardware_seconds = seconds_since(load_start);
+  const Usage with_hardware = measure_usage();
+
+  std::vector<std::string> names;
+  for (std::size_t i = 0; i < nr_instances; ++i) {
+    names.push_back(controller_name(i));
+    if (cm->load_controller(names.back(), CONTROLLER_TYPE) == nullptr) {
+      std::fprintf(stderr, "Failed to load '%s'.\n", names.back().c_str());
+      return false;
+    }
+  }
+  const double loaded_seconds = seconds_since(load_start);
+  for (const auto &name : names) {
+    if (cm->configure_controller(name) !=
+        controller_interface::return_type::OK) {
+      std::fprintf(stderr, "Failed to configure '%s'.\n", name.c_str());
+      return false;
+    }
+  }
+  const double configured_seconds = seconds_since(load_start);
+
+  // the switch is carried out by the update loop
+  const auto period = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / cm->get_update_rate()));
+  std::atomic<bool> running{true};
+  std::thread loop([&]() {
+    const rclcpp::Duration cm_period(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(period));
+    auto next = Clock::now();
+    while (running.load()) {
+      cm->read(cm->now(), cm_period);
+      cm->update(cm->now(), cm_period);
+      cm->write(cm->now(), cm_period);
+      next += period;
+      std::this_thread::sleep_until(next);
+    }
+  });
+  using SwitchRequest = controller_manager_msgs::srv::SwitchController::Request;
+  const auto switched =
+      cm->switch_controller(names, {}, SwitchRequest::STRICT, true,
+                            rclcpp::Duration::from_seconds(60.0));
+  running = false;
+  loop.join();
+  if (switched != controller_interface::return_type::OK) {
+    std::fprintf(stderr, "Failed to activate the controllers.\n");
+    return false;
+  }
+  const double activated_seconds = seconds_since(load_start);
+  const Usage with_controllers = measure_usage();
+
+  // the cycles run back to back, timing the controller_manager work only
+  std::vector<std::int64_t> cycle_durations;
+  cycle_durations.reserve(nr_cycles);
+  const rclcpp::Duration cm_period(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(period));
+  for (std::size_t n = 0; n < nr_cycles; ++n) {
+    const auto start = Clock::now();
+    cm->read(cm->now(), cm_period);
+    cm->update(cm->now(), cm_period);
+    cm->write(cm->now(), cm_period);
+    cycle_durations.push_back((Clock::now() - start).count());
+  }
+  std::sort(cycle_durations.begin(), cycle_durations.end());
+  const auto at = [&](const double fraction) {
+    return 1e-3 * static_cast<double>(cycle_durations[static_cast<std::size_t>(
+                      fraction * static_cast<double>(nr_cycles - 1))]);
+  };
+
+  const auto per_instance = [&](const std::int64_t value) {
+    return static_cast<double>(value) / static_cast<double>(nr_instances);
+  };
+  std::printf("%lu instances\n", nr_instances);
+  std::printf("  hardware %8.3f s  loaded %8.3f s  configured %8.3f s  "
+              "active %8.3f s\n",
+              hardware_seconds, loaded_seconds, configured_seconds,
+              activated_seconds);
+  std::printf("  per instance: heap %9.1f kB  resident %9.1f kB  threads "
+              "%6.2f\n",
+              1e-3 * per_instance(with_controllers.heap_bytes -
+                                  with_hardware.heap_bytes),
+              1e-3 * per_instance(with_controllers.resident_bytes -
+                                  with_hardware.resident_bytes),
+              per_instance(with_controllers.threads - with_hardware.threads));
+  std::printf("  total: heap %9.1f MB  resident %9.1f MB  threads %ld\n",
+              1e-6 * static_cast<double>(with_controllers.heap_bytes -
+                                         before.heap_bytes),
+              1e-6 * static_cast<double>(with_controllers.resident_bytes -
+                                         before.resident_bytes),
+              with_controllers.threads);
+  std::printf("  cycle: p50 %9.2f  p99 %9.2f  max %9.2f us, %7.3f us per "
+              "instance\n",
+              at(0.5), at(0.99), at(1.0), at(0.5) / nr_instances);
+  return true;
+}
+
+bool parse_options(int argc, char **argv, Options &options) {
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string name = argv[i];
+    const char *value = argv[i + 1];
+    if (name == "--instances") {
+      options.instances.clear();
+      std::istringstream list(value);
+      std::string count;
+      while (std::getline(list, count, ',')) {
+        options.instances.push_back(
+            static_cast<std::size_t>(std::atoi(count.c_str())));
+      }
+    } else if (name == "--cycles") {
+      options.cycles = static_cast<std::size_t>(std::atoi(value));
+    } else {
+      return false;
+    }
+  }
+  return argc % 2 == 1 && options.cycles > 0 && !options.instances.empty() &&
+         std::none_of(options.instances.begin(), options.instances.end(),
+                      [](const std::size_t n) { return n == 0; });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parse_options(argc, argv, options)) {
+    std::fprintf(stderr, "Usage: %s [--instances n[,n...]] [--cycles n]\n",
+                 argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const auto max_instances =
+      *std::max_element(options.instances.begin(), options.instances.end());
+  const std::string parameters_path =
+      "/tmp/benchmark_controller_scale_" + std::to_string(getpid()) + ".yaml";
+  if (!write_parameters(parameters_path, max_instances)) {
+    std::fprintf(stderr, "Failed to write '%s'.\n", parameters_path.c_str());
+    return EXIT_FAILURE;
+  }
+  const char *ros_args[] = {argv[0], "--ros-args", "--params-file",
+                            parameters_path.c_str()};
+  rclcpp::init(4, ros_args);
+
+  bool success = true;
+  for (const auto nr_instances : options.instances) {
+    success = run(make_urdf(nr_instances), nr_instances, options.cycles);
+    if (!success) {
+      break;
+    }
+  }
+
+  rclcpp::shutdown();
+  std::remove(parameters_path.c_str());
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,198 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmark of the wheel interface accesses of one update cycle through
+// loaned interfaces:
+//  - per use: the wheel states are read for the odometry and again for the
+//    controller state, the commands are read back for the stall check, the
+//    telemetry and the statistics and written wheel by wheel,
+//  - batched: the states are read once into an aligned array, the commands
+//    are kept in an aligned array, which all readers use, and stored in one
+//    pass.
+// Both variants compute the same checksum, a mismatch fails the run.
+//
+// Usage: benchmark_interface_access [--cycles n] [--repetitions n]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "hardware_interface/handle.hpp"
+#include "hardware_interface/loaned_command_interface.hpp"
+#include "hardware_interface/loaned_state_interface.hpp"
+#include "hardware_interface/types/hardware_interface_type_values.hpp"
+
+namespace { // utility
+
+using Clock = std::chrono::steady_clock;
+constexpr std::size_t NR_WHEELS = 4;
+
+struct Options {
+  std::size_t cycles = 10000000;
+  std::size_t repetitions = 5;
+};
+
+/// Loaned interfaces of the wheels as the controller gets them
+struct Wheels {
+  Wheels() {
+    for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+      const auto joint = "wheel_" + std::to_string(i);
+      states[i] = 0.1 * static_cast<double>(i + 1);
+      state_itfs.emplace_back(joint, hardware_interface::HW_IF_VELOCITY,
+                              &states[i]);
+      command_itfs.emplace_back(joint, hardware_interface::HW_IF_VELOCITY,
+                                &commands[i]);
+    }
+    for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+      loaned_states.emplace_back(state_itfs[i]);
+      loaned_commands.emplace_back(command_itfs[i]);
+    }
+  }
+
+  std::array<double, NR_WHEELS> states{};
+  std::array<double, NR_WHEELS> commands{};
+  std::vector<hardware_interface::StateInterface> state_itfs;
+  std::vector<hardware_interface::CommandInterface> command_itfs;
+  std::vector<hardware_interface::LoanedStateInterface> loaned_states;
+  std::vector<hardware_interface::LoanedCommandInterface> loaned_commands;
+};
+
+// stand-in for the controller's work on the values, kept cheap so the
+// accesses dominate
+double work(const double state, const double command) {
+  return 0.5 * state + 0.25 * command;
+}
+
+double cycle_per_use(Wheels &wheels, const double reference) {
+  double checksum = 0.0;
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    // odometry and stall check
+    checksum += work(wheels.loaned_states[i].get_value(),
+                     wheels.loaned_commands[i].get_value());
+  }
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    wheels.loaned_commands[i].set_value(reference * static_cast<double>(i));
+  }
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    // telemetry, statistics and controller state
+    checksum += work(wheels.loaned_states[i].get_value(),
+                     wheels.loaned_commands[i].get_value());
+    checksum += wheels.loaned_commands[i].get_value();
+  }
+  return checksum;
+}
+
+double cycle_batched(Wheels &wheels, std::array<double, NR_WHEELS> &commands,
+                     const double reference) {
+  alignas(64) std::array<double, NR_WHEELS> states;
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    states[i] = wheels.loaned_states[i].get_value();
+  }
+  double checksum = 0.0;
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    checksum += work(states[i], commands[i]);
+  }
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    commands[i] = reference * static_cast<double>(i);
+  }
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    wheels.loaned_commands[i].set_value(commands[i]);
+  }
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    checksum += work(states[i], commands[i]);
+    checksum += commands[i];
+  }
+  return checksum;
+}
+
+/// \return best ns per cycle, `checksum` receives the sum over the cycles
+template <typename Cycle>
+double measure(const Options &options, Cycle cycle, double &checksum) {
+  double best = 0.0;
+  for (std::size_t r = 0; r < options.repetitions; ++r) {
+    checksum = 0.0;
+    const auto start = Clock::now();
+    for (std::size_t n = 0; n < options.cycles; ++n) {
+      checksum += cycle(1e-6 * static_cast<double>(n % 1000));
+    }
+    const double ns =
+        std::chrono::duration<double, std::nano>(Clock::now() - start)
+            .count() /
+        static_cast<double>(options.cycles);
+    best = r == 0 ? ns : std::min(best, ns);
+  }
+  return best;
+}
+
+bool parse_options(int argc, char **argv, Options &options) {
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string name = argv[i];
+    const char *value = argv[i + 1];
+    if (name == "--cycles") {
+      options.cycles = static_cast<std::size_t>(std::atoll(value));
+    } else if (name == "--repetitions") {
+      options.repetitions = static_cast<std::size_t>(std::atoi(value));
+    } else {
+      return false;
+    }
+  }
+  return argc % 2 == 1 && options.cycles > 0 && options.repetitions > 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parse_options(argc, argv, options)) {
+    std::fprintf(stderr, "Usage: %s [--cycles n] [--repetitions n]\n",
+                 argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  Wheels per_use_wheels;
+  double per_use_checksum = 0.0;
+  const double per_use_ns = measure(
+      options,
+      [&](const double reference) {
+        return cycle_per_use(per_use_wheels, reference);
+      },
+      per_use_checksum);
+
+  Wheels batched_wheels;
+  std::array<double, NR_WHEELS> commands{};
+  double batched_checksum = 0.0;
+  const double batched_ns = measure(
+      options,
+      [&](const double reference) {
+        return cycle_batched(batched_wheels, commands, reference);
+      },
+      batched_checksum);
+
+  std::printf("%lu cycles, best of %lu runs\n", options.cycles,
+              options.repetitions);
+  std::printf("  per use  %8.2f ns/cycle\n", per_use_ns);
+  std::printf("  batched  %8.2f ns/cycle (%.2f ns saved)\n", batched_ns,
+              per_use_ns - batched_ns);
+
+  if (per_use_checksum != batched_checksum) {
+    std::fprintf(stderr, "Checksum mismatch: %.17g vs %.17g\n",
+                 per_use_checksum, batched_checksum);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
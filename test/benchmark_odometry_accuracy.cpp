@@ -0,0 +1,342 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Accuracy-per-CPU benchmark of the odometry core (forward kinematics and
+// pose integration). Trajectories with a known closed-form pose are turned
+// into wheel velocities through the inverse kinematics. The odometry then
+// integrates them for each time step, integration scheme and scalar type.
+// Reported per configuration:
+//  - final position and heading error wrt the exact pose,
+//  - CPU time of one update (FK and integration) [ns].
+// The wheel velocities of a step are sampled at its middle, as an encoder
+// difference over the step would give them.
+//
+// The `double`/`euler` row is the scheme of `Odometry::update()`. It is
+// checked bit-exact against `forward_kinematics()` and `integrate_pose()`,
+// and a mismatch fails the run.
+//
+// Usage: benchmark_odometry_accuracy [--duration s] [--repetitions n]
+//          [--trajectory circle|spiral|figure_eight|all]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "mecanum_drive_controller/kinematics.hpp"
+
+namespace { // utility
+
+using Clock = std::chrono::steady_clock;
+using mecanum_drive_controller::BodyTwist;
+using mecanum_drive_controller::MecanumKinematicsParams;
+using mecanum_drive_controller::NR_WHEELS;
+using mecanum_drive_controller::Pose2D;
+using mecanum_drive_controller::WheelVelocities;
+
+struct Options {
+  double duration = 60.0; // simulated time [s]
+  std::size_t repetitions = 5;
+  std::string trajectory = "all";
+};
+
+enum class Scheme { EULER, RUNGE_KUTTA_2, EXACT };
+
+const char *to_string(const Scheme scheme) {
+  switch (scheme) {
+  case Scheme::EULER:
+    return "euler";
+  case Scheme::RUNGE_KUTTA_2:
+    return "runge_kutta_2";
+  case Scheme::EXACT:
+    return "exact";
+  }
+  return "";
+}
+
+/// \brief Trajectory in the odometry frame given by its pose over time,
+/// starting at the origin like the odometry
+struct Trajectory {
+  const char *name;
+  Pose2D (*pose)(double t);
+  /// derivative of `pose`
+  Pose2D (*velocity)(double t);
+};
+
+// circle of 2 m radius at 1 m/s, heading tangential
+Pose2D circle_pose(const double t) {
+  return {2.0 * std::sin(0.5 * t), 2.0 * (1.0 - std::cos(0.5 * t)), 0.5 * t};
+}
+Pose2D circle_velocity(const double t) {
+  return {std::cos(0.5 * t), std::sin(0.5 * t), 0.5};
+}
+
+// outward spiral driven sideways while slowly turning, shifted to start at
+// the origin
+Pose2D spiral_pose(const double t) {
+  const double radius = 0.5 + 0.05 * t;
+  return {radius * std::cos(0.4 * t) - 0.5, radius * std::sin(0.4 * t),
+          0.1 * t};
+}
+Pose2D spiral_velocity(const double t) {
+  const double radius = 0.5 + 0.05 * t;
+  return {0.05 * std::cos(0.4 * t) - 0.4 * radius * std::sin(0.4 * t),
+          0.05 * std::sin(0.4 * t) + 0.4 * radius * std::cos(0.4 * t), 0.1};
+}
+
+// figure-eight with an oscillating and drifting heading
+Pose2D figure_eight_pose(const double t) {
+  return {3.0 * std::sin(0.3 * t), 1.5 * std::sin(0.6 * t),
+          0.8 * std::sin(0.3 * t) + 0.2 * t};
+}
+Pose2D figure_eight_velocity(const double t) {
+  return {0.9 * std::cos(0.3 * t), 0.9 * std::cos(0.6 * t),
+          0.24 * std::cos(0.3 * t) + 0.2};
+}
+
+const Trajectory TRAJECTORIES[] = {
+    {"circle", circle_pose, circle_velocity},
+    {"spiral", spiral_pose, spiral_velocity},
+    {"figure_eight", figure_eight_pose, figure_eight_velocity}};
+
+/// \brief Body twist of the trajectory at `t`
+BodyTwist body_twist(const Trajectory &trajectory, const double t) {
+  const auto pose = trajectory.pose(t);
+  const auto velocity = trajectory.velocity(t);
+  const double cos_rz = std::cos(pose.rz);
+  const double sin_rz = std::sin(pose.rz);
+  return {cos_rz * velocity.x + sin_rz * velocity.y,
+          -sin_rz * velocity.x + cos_rz * velocity.y, velocity.rz};
+}
+
+template <typename Scalar> struct Pose {
+  Scalar x = 0;
+  Scalar y = 0;
+  Scalar rz = 0;
+};
+
+/// \brief `forward_kinematics()` for a base frame at the center, in `Scalar`
+template <typename Scalar>
+inline void forward_kinematics(const Scalar wheels_radius,
+                               const Scalar sum_of_projections,
+                               const Scalar *wheels, Scalar &vx, Scalar &vy,
+                               Scalar &wz) {
+  const Scalar quarter_radius = Scalar(0.25) * wheels_radius;
+  vx = quarter_radius * (wheels[0] + wheels[3] + wheels[2] + wheels[1]);
+  vy = quarter_radius * (-wheels[0] + wheels[3] - wheels[2] + wheels[1]);
+  wz = Scalar(0.25) * wheels_radius / sum_of_projections *
+       (-wheels[0] - wheels[3] + wheels[2] + wheels[1]);
+}
+
+template <typename Scalar, Scheme SCHEME>
+inline void integrate(Pose<Scalar> &pose, const Scalar vx, const Scalar vy,
+                      const Scalar wz, const Scalar dt) {
+  if (SCHEME == Scheme::EULER) {
+    // as `integrate_pose()`: the heading is integrated after the position
+    const Scalar cos_rz = std::cos(pose.rz);
+    const Scalar sin_rz = std::sin(pose.rz);
+    pose.rz += wz * dt;
+    pose.x += (cos_rz * vx - sin_rz * vy) * dt;
+    pose.y += (sin_rz * vx + cos_rz * vy) * dt;
+  } else if (SCHEME == Scheme::RUNGE_KUTTA_2 ||
+             std::abs(wz * dt) < Scalar(1e-6)) {
+    // position along the mid-step heading
+    const Scalar rz = pose.rz + Scalar(0.5) * wz * dt;
+    const Scalar cos_rz = std::cos(rz);
+    const Scalar sin_rz = std::sin(rz);
+    pose.rz += wz * dt;
+    pose.x += (cos_rz * vx - sin_rz * vy) * dt;
+    pose.y += (sin_rz * vx + cos_rz * vy) * dt;
+  } else {
+    // arc of a constant twist over the step
+    const Scalar angle = wz * dt;
+    const Scalar sin_angle = std::sin(angle);
+    const Scalar one_minus_cos_angle = Scalar(1) - std::cos(angle);
+    const Scalar dx = (vx * sin_angle - vy * one_minus_cos_angle) / wz;
+    const Scalar dy = (vx * one_minus_cos_angle + vy * sin_angle) / wz;
+    const Scalar cos_rz = std::cos(pose.rz);
+    const Scalar sin_rz = std::sin(pose.rz);
+    pose.rz += angle;
+    pose.x += cos_rz * dx - sin_rz * dy;
+    pose.y += sin_rz * dx + cos_rz * dy;
+  }
+}
+
+struct Result {
+  double position_error = 0.0; // [m]
+  double heading_error = 0.0;  // [rad]
+  double nanoseconds_per_update = 0.0;
+};
+
+template <typename Scalar, Scheme SCHEME>
+Result run(const MecanumKinematicsParams &params,
+           const std::vector<double> &wheel_velocities, const double dt,
+           const Pose2D &expected, const std::size_t repetitions,
+           Pose2D &final_pose) {
+  const std::size_t count = wheel_velocities.size() / NR_WHEELS;
+  std::vector<Scalar> wheels(wheel_velocities.begin(),
+                             wheel_velocities.end());
+  const auto wheels_radius = static_cast<Scalar>(params.wheels_radius);
+  const auto sum_of_projections = static_cast<Scalar>(
+      params.sum_of_robot_center_projection_on_X_Y_axis);
+  const auto step = static_cast<Scalar>(dt);
+
+  Result result;
+  Pose<Scalar> pose;
+  auto best = Clock::duration::max();
+  for (std::size_t repetition = 0; repetition < repetitions; ++repetition) {
+    pose = Pose<Scalar>();
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+      Scalar vx, vy, wz;
+      forward_kinematics(wheels_radius, sum_of_projections,
+                         &wheels[NR_WHEELS * i], vx, vy, wz);
+      integrate<Scalar, SCHEME>(pose, vx, vy, wz, step);
+    }
+    best = std::min(best, Clock::now() - start);
+  }
+  final_pose = {pose.x, pose.y, pose.rz};
+
+  result.position_error = std::hypot(final_pose.x - expected.x,
+                                     final_pose.y - expected.y);
+  result.heading_error = std::abs(final_pose.rz - expected.rz);
+  result.nanoseconds_per_update =
+      static_cast<double>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(best).count()) /
+      static_cast<double>(count);
+  return result;
+}
+
+void print(const char *trajectory, const char *scalar, const Scheme scheme,
+           const double dt, const Result &result) {
+  std::printf("%-13s %-7s %-14s %8.4f %14.3e %14.3e %10.2f\n", trajectory,
+              scalar, to_string(scheme), dt, result.position_error,
+              result.heading_error, result.nanoseconds_per_update);
+}
+
+template <Scheme SCHEME>
+void run_scheme(const Trajectory &trajectory,
+                const MecanumKinematicsParams &params,
+                const std::vector<double> &wheel_velocities, const double dt,
+                const Pose2D &expected, const Options &options,
+                Pose2D &double_pose) {
+  Pose2D float_pose;
+  print(trajectory.name, "float", SCHEME, dt,
+        run<float, SCHEME>(params, wheel_velocities, dt, expected,
+                           options.repetitions, float_pose));
+  print(trajectory.name, "double", SCHEME, dt,
+        run<double, SCHEME>(params, wheel_velocities, dt, expected,
+                            options.repetitions, double_pose));
+}
+
+bool parse_options(int argc, char **argv, Options &options) {
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string name = argv[i];
+    const char *value = argv[i + 1];
+    if (name == "--duration") {
+      options.duration = std::atof(value);
+    } else if (name == "--repetitions") {
+      options.repetitions = static_cast<std::size_t>(std::atoi(value));
+    } else if (name == "--trajectory") {
+      options.trajectory = value;
+    } else {
+      return false;
+    }
+  }
+  const bool is_trajectory_known =
+      options.trajectory == "all" ||
+      std::any_of(std::begin(TRAJECTORIES), std::end(TRAJECTORIES),
+                  [&](const Trajectory &trajectory) {
+                    return options.trajectory == trajectory.name;
+                  });
+  return argc % 2 == 1 && options.duration > 0.0 &&
+         options.repetitions > 0 && is_trajectory_known;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parse_options(argc, argv, options)) {
+    std::fprintf(stderr,
+                 "Usage: %s [--duration s] [--repetitions n] "
+                 "[--trajectory circle|spiral|figure_eight|all]\n",
+                 argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  MecanumKinematicsParams params;
+  params.wheels_radius = 0.05;
+  params.sum_of_robot_center_projection_on_X_Y_axis = 0.5;
+  constexpr double DTS[] = {0.001, 0.002, 0.005, 0.01, 0.02, 0.05};
+
+  std::printf("%.1f s per trajectory, best of %lu runs\n", options.duration,
+              options.repetitions);
+  std::printf("%-13s %-7s %-14s %8s %14s %14s %10s\n", "trajectory", "scalar",
+              "integration", "dt [s]", "position [m]", "heading [rad]",
+              "ns/update");
+
+  bool is_core_matched = true;
+  for (const auto &trajectory : TRAJECTORIES) {
+    if (options.trajectory != "all" && options.trajectory != trajectory.name) {
+      continue;
+    }
+    for (const double dt : DTS) {
+      const auto count = static_cast<std::size_t>(options.duration / dt);
+      std::vector<double> wheel_velocities(NR_WHEELS * count);
+      for (std::size_t i = 0; i < count; ++i) {
+        const auto wheels = mecanum_drive_controller::inverse_kinematics(
+            params,
+            body_twist(trajectory, (static_cast<double>(i) + 0.5) * dt));
+        std::copy(wheels.begin(), wheels.end(),
+                  wheel_velocities.begin() + NR_WHEELS * i);
+      }
+      const auto expected =
+          trajectory.pose(static_cast<double>(count) * dt);
+
+      Pose2D euler_pose;
+      Pose2D pose;
+      run_scheme<Scheme::EULER>(trajectory, params, wheel_velocities, dt,
+                                expected, options, euler_pose);
+      run_scheme<Scheme::RUNGE_KUTTA_2>(trajectory, params, wheel_velocities,
+                                        dt, expected, options, pose);
+      run_scheme<Scheme::EXACT>(trajectory, params, wheel_velocities, dt,
+                                expected, options, pose);
+
+      // the double Euler row has to be the odometry core
+      Pose2D core_pose;
+      for (std::size_t i = 0; i < count; ++i) {
+        const double *w = &wheel_velocities[NR_WHEELS * i];
+        mecanum_drive_controller::integrate_pose(
+            core_pose,
+            mecanum_drive_controller::forward_kinematics(
+                params, {w[0], w[1], w[2], w[3]}),
+            dt);
+      }
+      if (core_pose.x != euler_pose.x || core_pose.y != euler_pose.y ||
+          core_pose.rz != euler_pose.rz) {
+        std::fprintf(stderr,
+                     "%s, dt %g: the Euler scheme differs from the odometry "
+                     "core.\n",
+                     trajectory.name, dt);
+        is_core_matched = false;
+      }
+    }
+  }
+  return is_core_matched ? EXIT_SUCCESS : EXIT_FAILURE;
+}
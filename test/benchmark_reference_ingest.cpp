@@ -0,0 +1,356 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Contention benchmark and stress test of the reference ingest path: several
+// publisher threads write references the way `reference_callback` does while
+// a pinned RT thread reads them the way `update_reference_from_subscribers`
+// does. Reported per buffer implementation:
+//  - RT read latency (read and copy of the reference),
+//  - stale reads: reads returning an older reference than the last completed
+//    write, i.e. reads which failed or were blocked by a writer,
+//  - end-to-end command age at the time of the RT read,
+//  - writer latency,
+//  - torn references (fields of different writes), which fail the run.
+//
+// Usage: benchmark_reference_ingest [--duration s] [--publishers n]
+//          [--publish-rate hz] [--rt-rate hz]
+//          [--buffer realtime_buffer|seqlock|all]
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "geometry_msgs/msg/twist_stamped.hpp"
+#include "mecanum_drive_controller/seqlock.hpp"
+#include "realtime_tools/realtime_buffer.h"
+
+namespace { // utility
+
+using Clock = std::chrono::steady_clock;
+using ReferenceMsg = geometry_msgs::msg::TwistStamped;
+
+struct Options {
+  double duration = 5.0;        // [s]
+  std::size_t publishers = 3;   // number of publisher threads
+  double publish_rate = 3000.0; // per publisher [Hz]
+  double rt_rate = 2000.0;      // [Hz]
+  std::string buffer = "all";
+};
+
+/// Reference as written by the publishers, consistent if
+/// linear_y == -linear_x and angular_z == 2 * linear_x
+struct Reference {
+  std::int64_t stamp_nanoseconds;
+  std::uint64_t sequence;
+  double linear_x;
+  double linear_y;
+  double angular_z;
+};
+
+std::int64_t now_nanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Clock::now().time_since_epoch())
+      .count();
+}
+
+Reference make_reference(const std::uint64_t sequence) {
+  const double value = static_cast<double>(sequence);
+  return {now_nanoseconds(), sequence, value, -value, 2.0 * value};
+}
+
+bool is_torn(const Reference &reference) {
+  return reference.linear_y != -reference.linear_x ||
+         reference.angular_z != 2.0 * reference.linear_x ||
+         reference.linear_x != static_cast<double>(reference.sequence);
+}
+
+void pin_thread(std::thread &thread, const std::size_t cpu) {
+  const auto nr_cpus = std::max(1u, std::thread::hardware_concurrency());
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu % nr_cpus, &cpu_set);
+  pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set), &cpu_set);
+}
+
+void try_set_realtime_priority(std::thread &thread) {
+  // needs CAP_SYS_NICE or an rtprio limit, the benchmark runs without
+  sched_param param{};
+  param.sched_priority = 80;
+  pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param);
+}
+
+/// \brief `input_ref_` as used by the controller
+class RealtimeBufferIngest {
+public:
+  static constexpr const char *NAME = "realtime_buffer";
+
+  void write(const Reference &reference) {
+    // the subscription delivers a freshly allocated message
+    auto msg = std::make_shared<ReferenceMsg>();
+    msg->header.stamp.sec =
+        static_cast<std::int32_t>(reference.stamp_nanoseconds / 1000000000);
+    msg->header.stamp.nanosec =
+        static_cast<std::uint32_t>(reference.stamp_nanoseconds % 1000000000);
+    // the sequence travels in an unused field
+    msg->twist.linear.z = static_cast<double>(reference.sequence);
+    msg->twist.linear.x = reference.linear_x;
+    msg->twist.linear.y = reference.linear_y;
+    msg->twist.angular.z = reference.angular_z;
+    buffer_.writeFromNonRT(msg);
+  }
+
+  bool read(Reference &reference) {
+    // copy of the shared pointer as in `update_reference_from_subscribers`
+    const auto msg = *(buffer_.readFromRT());
+    if (!msg) {
+      return false;
+    }
+    reference.stamp_nanoseconds =
+        static_cast<std::int64_t>(msg->header.stamp.sec) * 1000000000 +
+        msg->header.stamp.nanosec;
+    reference.sequence = static_cast<std::uint64_t>(msg->twist.linear.z);
+    reference.linear_x = msg->twist.linear.x;
+    reference.linear_y = msg->twist.linear.y;
+    reference.angular_z = msg->twist.angular.z;
+    return true;
+  }
+
+private:
+  realtime_tools::RealtimeBuffer<std::shared_ptr<ReferenceMsg>> buffer_;
+};
+
+/// \brief Lock-free read side: the writers are serialized by a mutex, the RT
+/// thread reads once and keeps its last value if a write is in progress
+class SeqLockIngest {
+public:
+  static constexpr const char *NAME = "seqlock";
+
+  void write(const Reference &reference) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    seqlock_.store(reference);
+  }
+
+  bool read(Reference &reference) {
+    if (seqlock_.version() == 0) {
+      return false;
+    }
+    if (seqlock_.try_load(last_reference_)) {
+      has_reference_ = true;
+    }
+    reference = last_reference_;
+    return has_reference_;
+  }
+
+private:
+  std::mutex write_mutex_;
+  mecanum_drive_controller::SeqLock<Reference> seqlock_;
+  Reference last_reference_{};
+  bool has_reference_ = false;
+};
+
+struct Percentiles {
+  std::int64_t p50 = 0;
+  std::int64_t p99 = 0;
+  std::int64_t p999 = 0;
+  std::int64_t max = 0;
+};
+
+Percentiles percentiles(std::vector<std::int64_t> &samples) {
+  Percentiles result;
+  if (samples.empty()) {
+    return result;
+  }
+  std::sort(samples.begin(), samples.end());
+  const auto at = [&](const double fraction) {
+    return samples[static_cast<std::size_t>(
+        fraction * static_cast<double>(samples.size() - 1))];
+  };
+  result.p50 = at(0.5);
+  result.p99 = at(0.99);
+  result.p999 = at(0.999);
+  result.max = samples.back();
+  return result;
+}
+
+void print_percentiles(const char *name, Percentiles p) {
+  std::printf("  %-22s p50 %9.2f  p99 %9.2f  p99.9 %9.2f  max %9.2f us\n",
+              name, 1e-3 * static_cast<double>(p.p50),
+              1e-3 * static_cast<double>(p.p99),
+              1e-3 * static_cast<double>(p.p999),
+              1e-3 * static_cast<double>(p.max));
+}
+
+/// \return number of torn references
+template <typename Ingest> std::uint64_t run(const Options &options) {
+  Ingest ingest;
+  std::atomic<bool> running{true};
+  // the subscription callbacks of one node are serialized by the executor,
+  // so are the publisher threads here
+  std::mutex callback_mutex;
+  std::uint64_t next_sequence = 1;
+  std::atomic<std::uint64_t> completed_sequence{0};
+
+  const auto nr_rt_samples =
+      static_cast<std::size_t>(options.duration * options.rt_rate) + 16;
+  const auto nr_publisher_samples =
+      static_cast<std::size_t>(options.duration * options.publish_rate) + 16;
+
+  std::vector<std::vector<std::int64_t>> write_latencies(options.publishers);
+  std::vector<std::thread> publishers;
+  for (std::size_t i = 0; i < options.publishers; ++i) {
+    write_latencies[i].reserve(nr_publisher_samples);
+    publishers.emplace_back([&, i]() {
+      const auto period = std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / options.publish_rate));
+      auto next = Clock::now();
+      while (running.load(std::memory_order_relaxed)) {
+        const auto start = Clock::now();
+        {
+          std::lock_guard<std::mutex> lock(callback_mutex);
+          const auto reference = make_reference(next_sequence++);
+          ingest.write(reference);
+          completed_sequence.store(reference.sequence,
+                                   std::memory_order_release);
+        }
+        if (write_latencies[i].size() < write_latencies[i].capacity()) {
+          write_latencies[i].push_back((Clock::now() - start).count());
+        }
+        next += period;
+        std::this_thread::sleep_until(next);
+      }
+    });
+    pin_thread(publishers.back(), i + 1);
+  }
+
+  std::vector<std::int64_t> read_latencies;
+  std::vector<std::int64_t> ages;
+  read_latencies.reserve(nr_rt_samples);
+  ages.reserve(nr_rt_samples);
+  std::uint64_t reads = 0;
+  std::uint64_t stale_reads = 0;
+  std::uint64_t torn_reads = 0;
+  std::thread rt_thread([&]() {
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / options.rt_rate));
+    const auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                        std::chrono::duration<double>(
+                                            options.duration));
+    auto next = Clock::now();
+    while (next < end) {
+      const auto completed =
+          completed_sequence.load(std::memory_order_acquire);
+      const auto start = Clock::now();
+      Reference reference;
+      const bool valid = ingest.read(reference);
+      const auto stop = Clock::now();
+
+      if (valid && read_latencies.size() < read_latencies.capacity()) {
+        ++reads;
+        read_latencies.push_back((stop - start).count());
+        ages.push_back(now_nanoseconds() - reference.stamp_nanoseconds);
+        stale_reads += reference.sequence < completed ? 1 : 0;
+        torn_reads += is_torn(reference) ? 1 : 0;
+      }
+      next += period;
+      std::this_thread::sleep_until(next);
+    }
+  });
+  pin_thread(rt_thread, 0);
+  try_set_realtime_priority(rt_thread);
+
+  rt_thread.join();
+  running = false;
+  for (auto &publisher : publishers) {
+    publisher.join();
+  }
+
+  std::vector<std::int64_t> all_write_latencies;
+  for (const auto &latencies : write_latencies) {
+    all_write_latencies.insert(all_write_latencies.end(), latencies.begin(),
+                               latencies.end());
+  }
+
+  std::printf("%s: %lu writes, %lu RT reads, %lu stale (%.3f %%), %lu torn\n",
+              Ingest::NAME, next_sequence - 1, reads, stale_reads,
+              reads > 0 ? 100.0 * static_cast<double>(stale_reads) /
+                              static_cast<double>(reads)
+                        : 0.0,
+              torn_reads);
+  print_percentiles("RT read latency", percentiles(read_latencies));
+  print_percentiles("command age", percentiles(ages));
+  print_percentiles("write latency", percentiles(all_write_latencies));
+  return torn_reads;
+}
+
+bool parse_options(int argc, char **argv, Options &options) {
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string name = argv[i];
+    const char *value = argv[i + 1];
+    if (name == "--duration") {
+      options.duration = std::atof(value);
+    } else if (name == "--publishers") {
+      options.publishers = static_cast<std::size_t>(std::atoi(value));
+    } else if (name == "--publish-rate") {
+      options.publish_rate = std::atof(value);
+    } else if (name == "--rt-rate") {
+      options.rt_rate = std::atof(value);
+    } else if (name == "--buffer") {
+      options.buffer = value;
+    } else {
+      return false;
+    }
+  }
+  return argc % 2 == 1 && options.duration > 0.0 && options.publishers > 0 &&
+         options.publish_rate > 0.0 && options.rt_rate > 0.0 &&
+         (options.buffer == "all" || options.buffer == "realtime_buffer" ||
+          options.buffer == "seqlock");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parse_options(argc, argv, options)) {
+    std::fprintf(stderr,
+                 "Usage: %s [--duration s] [--publishers n] "
+                 "[--publish-rate hz] [--rt-rate hz] "
+                 "[--buffer realtime_buffer|seqlock|all]\n",
+                 argv[0]);
+    return EXIT_FAILURE;
+  }
+  std::printf("%lu publishers at %.0f Hz, RT loop at %.0f Hz, %.1f s\n",
+              options.publishers, options.publish_rate, options.rt_rate,
+              options.duration);
+
+  std::uint64_t torn_reads = 0;
+  if (options.buffer == "all" || options.buffer == "realtime_buffer") {
+    torn_reads += run<RealtimeBufferIngest>(options);
+  }
+  if (options.buffer == "all" || options.buffer == "seqlock") {
+    torn_reads += run<SeqLockIngest>(options);
+  }
+  return torn_reads == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
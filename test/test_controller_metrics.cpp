@@ -0,0 +1,50 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <string>
+
+#include "mecanum_drive_controller/controller_metrics.hpp"
+#include "mecanum_drive_controller/fault_monitor.hpp"
+#include "mecanum_drive_controller/load_shedder.hpp"
+
+TEST(ControllerMetricsTest, when_cycles_timed_expect_cumulative_histogram) {
+  mecanum_drive_controller::ControllerMetrics metrics;
+  metrics.record_cycle_duration(std::chrono::microseconds(5));
+  metrics.record_cycle_duration(std::chrono::microseconds(10));
+  metrics.record_cycle_duration(std::chrono::microseconds(200));
+  metrics.record_cycle_duration(std::chrono::milliseconds(20));
+  EXPECT_EQ(metrics.cycle_duration_bucket(0), 2u);
+  EXPECT_EQ(metrics.cycle_duration_bucket(4), 1u);
+  EXPECT_EQ(metrics.cycle_duration_bucket(
+                mecanum_drive_controller::ControllerMetrics::
+                    NR_CYCLE_DURATION_BUCKETS -
+                1),
+            1u);
+
+  const std::string text = metrics.render_prometheus(
+      "a\"b", mecanum_drive_controller::LoadShedder(),
+      mecanum_drive_controller::FaultMonitor());
+  const std::string bucket =
+      "mecanum_drive_controller_cycle_duration_seconds_bucket"
+      "{controller=\"a\\\"b\",";
+  EXPECT_NE(text.find(bucket + "le=\"1e-05\"} 2\n"), std::string::npos);
+  EXPECT_NE(text.find(bucket + "le=\"0.00025\"} 3\n"), std::string::npos);
+  EXPECT_NE(text.find(bucket + "le=\"+Inf\"} 4\n"), std::string::npos);
+  EXPECT_NE(text.find("# TYPE mecanum_drive_controller_cycle_duration_seconds "
+                      "histogram\n"),
+            std::string::npos);
+}
@@ -0,0 +1,116 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cmath>
+
+#include "mecanum_drive_controller/drivetrain_model.hpp"
+
+using mecanum_drive_controller::DrivetrainModel;
+using mecanum_drive_controller::DrivetrainModelParams;
+using mecanum_drive_controller::NR_WHEELS;
+using mecanum_drive_controller::WheelVelocities;
+
+namespace {
+
+DrivetrainModelParams make_params() {
+  DrivetrainModelParams params;
+  params.kinematics.wheels_radius = 0.5;
+  params.kinematics.sum_of_robot_center_projection_on_X_Y_axis = 1.0;
+  return params;
+}
+
+} // namespace
+
+TEST(DrivetrainModelTest, when_commanded_expect_first_order_response) {
+  auto params = make_params();
+  params.time_constant = 0.1;
+  DrivetrainModel model;
+  model.configure(params);
+
+  model.set_commands({1.0, 1.0, 1.0, 1.0});
+  for (int i = 0; i < 10; ++i) {
+    model.step(0.01);
+  }
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    EXPECT_NEAR(model.true_velocities()[i], 1.0 - std::exp(-1.0), 1e-12);
+  }
+  EXPECT_NEAR(model.time(), 0.1, 1e-12);
+}
+
+TEST(DrivetrainModelTest, when_command_delayed_expect_late_saturated_response) {
+  auto params = make_params();
+  params.command_delay = 0.045;
+  params.max_velocity = 2.0;
+  DrivetrainModel model;
+  model.configure(params);
+
+  for (int i = 0; i < 5; ++i) {
+    model.set_commands({3.0, -3.0, 1.0, 0.0});
+    model.step(0.01);
+    EXPECT_EQ(model.true_velocities()[0], 0.0) << "step " << i;
+  }
+  model.set_commands({3.0, -3.0, 1.0, 0.0});
+  model.step(0.01);
+  EXPECT_EQ(model.true_velocities()[0], 2.0);
+  EXPECT_EQ(model.true_velocities()[1], -2.0);
+  EXPECT_EQ(model.true_velocities()[2], 1.0);
+  EXPECT_EQ(model.true_velocities()[3], 0.0);
+}
+
+TEST(DrivetrainModelTest, when_moving_slowly_expect_quantized_encoders) {
+  auto params = make_params();
+  params.encoder_resolution = 100.0;
+  DrivetrainModel model;
+  model.configure(params);
+  const double tick = 2.0 * M_PI / 100.0;
+
+  // a quarter tick per cycle
+  const double velocity = 0.25 * tick / 0.01;
+  model.set_commands({velocity, velocity, velocity, velocity});
+  double velocity_sum = 0.0;
+  for (int i = 0; i < 40; ++i) {
+    model.step(0.01);
+    const double ticks = model.positions()[0] / tick;
+    EXPECT_NEAR(ticks, std::round(ticks), 1e-9);
+    EXPECT_TRUE(model.velocities()[0] == 0.0 ||
+                std::abs(model.velocities()[0] - tick / 0.01) < 1e-9);
+    velocity_sum += model.velocities()[0];
+  }
+  // the quantization error does not accumulate
+  EXPECT_NEAR(velocity_sum / 40, velocity, tick / 0.4);
+}
+
+TEST(DrivetrainModelTest, when_rollers_slip_expect_encoders_unaffected) {
+  auto params = make_params();
+  DrivetrainModel ideal;
+  ideal.configure(params);
+  params.slip_ratio.fill(0.5);
+  DrivetrainModel slipping;
+  slipping.configure(params);
+
+  const WheelVelocities commands = {3.0, 3.0, 3.0, 3.0};
+  ideal.set_commands(commands);
+  slipping.set_commands(commands);
+  for (int i = 0; i < 100; ++i) {
+    ideal.step(0.01);
+    slipping.step(0.01);
+  }
+  // 1.5 m/s, the first step averages the velocity before the command
+  EXPECT_NEAR(ideal.pose().x, 1.5, 0.01);
+  EXPECT_NEAR(slipping.pose().x, 0.5 * ideal.pose().x, 1e-9);
+  EXPECT_EQ(slipping.positions(), ideal.positions());
+  EXPECT_EQ(slipping.velocities(), ideal.velocities());
+}
@@ -0,0 +1,49 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cstddef>
+
+#include "mecanum_drive_controller/fault_monitor.hpp"
+
+TEST(FaultMonitorTest, when_auto_recovery_disabled_expect_reset_required) {
+  using mecanum_drive_controller::ControllerMode;
+  using mecanum_drive_controller::FaultConditions;
+  mecanum_drive_controller::FaultMonitor monitor;
+  monitor.configure(false, 1, 1.0, 0.1, 3);
+
+  // wheel 0 is commanded but does not move for 3 cycles
+  FaultConditions conditions;
+  for (size_t i = 0; i < 3; ++i) {
+    conditions.wheel_stalled = monitor.check_stall(0, 2.0, 0.0);
+    conditions.wheel_stalled |= monitor.check_stall(1, 2.0, 2.0);
+    monitor.update(conditions);
+  }
+  EXPECT_TRUE(conditions.wheel_stalled);
+  EXPECT_EQ(monitor.mode(), ControllerMode::FAULT);
+  EXPECT_EQ(monitor.stall_count(), 1u);
+
+  conditions.wheel_stalled = false;
+  for (size_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(monitor.update(conditions), ControllerMode::FAULT);
+  }
+  monitor.request_reset();
+  EXPECT_EQ(monitor.update(conditions), ControllerMode::RECOVERING);
+
+  conditions.reference_stale = true;
+  EXPECT_EQ(monitor.update(conditions), ControllerMode::DEGRADED);
+  conditions.reference_stale = false;
+  EXPECT_EQ(monitor.update(conditions), ControllerMode::RUNNING);
+}
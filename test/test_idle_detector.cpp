@@ -0,0 +1,50 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <array>
+#include <chrono>
+#include <limits>
+
+#include "mecanum_drive_controller/idle_detector.hpp"
+
+TEST(IdleDetectorTest, when_wheel_moves_or_state_nan_expect_awake) {
+  mecanum_drive_controller::IdleDetector detector;
+  const std::array<double, 4> standstill = {0.0, -0.01, 0.01, 0.0};
+  const auto period = std::chrono::milliseconds(10);
+  EXPECT_FALSE(detector.update(false, standstill.data(), 4, period));
+
+  detector.configure(1, 0.01, std::chrono::milliseconds(20));
+  EXPECT_FALSE(detector.update(false, standstill.data(), 4, period));
+  EXPECT_TRUE(detector.update(false, standstill.data(), 4, period));
+  EXPECT_FALSE(detector.should_publish());
+  EXPECT_TRUE(detector.update(false, standstill.data(), 4, period));
+  EXPECT_FALSE(detector.should_publish());
+  EXPECT_TRUE(detector.update(false, standstill.data(), 4, period));
+  EXPECT_TRUE(detector.should_publish());
+
+  auto moving = standstill;
+  moving[3] = -0.02;
+  EXPECT_FALSE(detector.update(false, moving.data(), 4, period));
+  EXPECT_TRUE(detector.should_publish());
+  EXPECT_FALSE(detector.update(false, standstill.data(), 4, period));
+  EXPECT_TRUE(detector.update(false, standstill.data(), 4, period));
+
+  auto invalid = standstill;
+  invalid[1] = std::numeric_limits<double>::quiet_NaN();
+  EXPECT_FALSE(detector.update(false, invalid.data(), 4, period));
+  EXPECT_FALSE(detector.update(true, standstill.data(), 4, period));
+  EXPECT_EQ(detector.idle_cycle_count(), 4u);
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "mecanum_drive_controller/kinematics.hpp"
+#include "mecanum_drive_controller/odometry.hpp"
+#include "rclcpp/time.hpp"
+
+TEST(KinematicsTest, when_batch_integrated_expect_same_as_odometry_update) {
+  mecanum_drive_controller::MecanumKinematicsParams params;
+  params.wheels_radius = 0.5;
+  params.sum_of_robot_center_projection_on_X_Y_axis = 1.0;
+  params.base_frame_offset = {0.2, -0.1, 0.3};
+
+  // forward kinematics inverts the inverse kinematics
+  const auto wheels = mecanum_drive_controller::inverse_kinematics(
+      params, {1.5, -0.4, 0.7});
+  const auto twist =
+      mecanum_drive_controller::forward_kinematics(params, wheels);
+  EXPECT_NEAR(twist.linear_x, 1.5, 1e-12);
+  EXPECT_NEAR(twist.linear_y, -0.4, 1e-12);
+  EXPECT_NEAR(twist.angular_z, 0.7, 1e-12);
+
+  mecanum_drive_controller::Odometry odometry;
+  odometry.setWheelsParams(params.sum_of_robot_center_projection_on_X_Y_axis,
+                           params.wheels_radius);
+  odometry.init(rclcpp::Time(0), params.base_frame_offset);
+
+  constexpr size_t count = 100;
+  std::vector<double> wheel_velocities(4 * count);
+  std::vector<double> dts(count, 0.01);
+  for (size_t i = 0; i < wheel_velocities.size(); ++i) {
+    wheel_velocities[i] = std::sin(0.1 * static_cast<double>(i));
+  }
+  // invalid samples are skipped
+  wheel_velocities[4 * 10 + 2] = std::numeric_limits<double>::quiet_NaN();
+  for (size_t i = 0; i < count; ++i) {
+    const double *w = &wheel_velocities[4 * i];
+    if (!std::isnan(w[2])) {
+      odometry.update(w[0], w[3], w[2], w[1], dts[i], 0);
+    }
+  }
+
+  mecanum_drive_controller::Pose2D pose;
+  std::vector<double> poses(3 * count);
+  mecanum_drive_controller::integrate_odometry_batch(
+      params, pose, wheel_velocities.data(), dts.data(), count, poses.data(),
+      nullptr);
+  EXPECT_EQ(pose.x, odometry.getX());
+  EXPECT_EQ(pose.y, odometry.getY());
+  EXPECT_EQ(pose.rz, odometry.getRz());
+  EXPECT_EQ(poses[3 * (count - 1)], odometry.getX());
+  EXPECT_EQ(poses[3 * 10], poses[3 * 9]);
+}
+
+// one twist drives both coupled bases, the odometry fuses all wheels
+TEST(KinematicsTest, when_bases_coupled_expect_consistent_ik_and_fused_fk) {
+  mecanum_drive_controller::MecanumKinematicsParams params;
+  params.wheels_radius = 0.5;
+  params.sum_of_robot_center_projection_on_X_Y_axis = 1.0;
+
+  // second base 2 m ahead, 0.5 m left and turned by 90 degrees
+  mecanum_drive_controller::CoupledKinematics kinematics;
+  ASSERT_TRUE(kinematics.configure({params, params},
+                                   {mecanum_drive_controller::Pose2D(),
+                                    mecanum_drive_controller::Pose2D{
+                                        2.0, 0.5, M_PI / 2.0}}));
+
+  const mecanum_drive_controller::BodyTwist twist{0.8, -0.3, 0.4};
+  const auto wheels = kinematics.inverse(twist);
+  // the second base moves with (0.8 - 0.4 * 0.5, -0.3 + 0.4 * 2), which is
+  // (0.5, -0.6) in its own frame
+  const auto first_wheels =
+      mecanum_drive_controller::inverse_kinematics(params, twist);
+  const auto second_wheels =
+      mecanum_drive_controller::inverse_kinematics(params, {0.5, -0.6, 0.4});
+  for (size_t i = 0; i < mecanum_drive_controller::NR_WHEELS; ++i) {
+    EXPECT_NEAR(wheels[i], first_wheels[i], 1e-12);
+    EXPECT_NEAR(wheels[mecanum_drive_controller::NR_WHEELS + i],
+                second_wheels[i], 1e-12);
+  }
+
+  const auto fused = kinematics.forward(wheels);
+  EXPECT_NEAR(fused.linear_x, 0.8, 1e-12);
+  EXPECT_NEAR(fused.linear_y, -0.3, 1e-12);
+  EXPECT_NEAR(fused.angular_z, 0.4, 1e-12);
+
+  // with a slipping wheel the fused twist fits the wheels better than the
+  // commanded one
+  auto measured = wheels;
+  measured[5] += 0.3;
+  const auto residual = [&](const mecanum_drive_controller::BodyTwist &t) {
+    const auto fitted = kinematics.inverse(t);
+    double sum = 0.0;
+    for (size_t i = 0; i < measured.size(); ++i) {
+      sum += (fitted[i] - measured[i]) * (fitted[i] - measured[i]);
+    }
+    return sum;
+  };
+  EXPECT_LT(residual(kinematics.forward(measured)), residual(twist));
+
+  params.wheels_radius = 0.0;
+  EXPECT_FALSE(kinematics.configure({params, params},
+                                    {mecanum_drive_controller::Pose2D(),
+                                     mecanum_drive_controller::Pose2D()}));
+}
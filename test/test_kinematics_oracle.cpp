@@ -0,0 +1,478 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Differential tests of the kinematics kernels against a reference
+// implementation of the plain matrix math in extended precision. Every kernel
+// that gets precomputed, batched or vectorized has to stay within a few ULP of
+// the magnitude of the terms it sums up.
+
+#include <gmock/gmock.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "mecanum_drive_controller/kinematics.hpp"
+
+using mecanum_drive_controller::BodyTwist;
+using mecanum_drive_controller::CoupledKinematics;
+using mecanum_drive_controller::CoupledWheelVelocities;
+using mecanum_drive_controller::MecanumKinematicsParams;
+using mecanum_drive_controller::NR_COUPLED_BASES;
+using mecanum_drive_controller::NR_COUPLED_WHEELS;
+using mecanum_drive_controller::NR_WHEELS;
+using mecanum_drive_controller::Pose2D;
+using mecanum_drive_controller::WheelVelocities;
+
+namespace {
+
+constexpr std::size_t NR_CASES = 1000000;
+constexpr double EPSILON = std::numeric_limits<double>::epsilon();
+constexpr double DENORM_MIN = std::numeric_limits<double>::denorm_min();
+
+using Twist = std::array<long double, 3>;
+
+// wheel velocities [rad/s] of the center twist, rows of the mecanum Jacobian
+std::array<long double, NR_WHEELS>
+reference_mecanum_ik(const MecanumKinematicsParams &params,
+                     const Twist &center_twist) {
+  const long double l = params.sum_of_robot_center_projection_on_X_Y_axis;
+  const long double jacobian[NR_WHEELS][3] = {
+      {1, -1, -l}, {1, 1, l}, {1, -1, l}, {1, 1, -l}};
+  std::array<long double, NR_WHEELS> wheels;
+  for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+    wheels[i] = (jacobian[i][0] * center_twist[0] +
+                 jacobian[i][1] * center_twist[1] +
+                 jacobian[i][2] * center_twist[2]) /
+                params.wheels_radius;
+  }
+  return wheels;
+}
+
+// v_center = R(theta) v_base - w x p_base
+Twist reference_base_to_center(const MecanumKinematicsParams &params,
+                               const Twist &twist) {
+  const long double theta = params.base_frame_offset[2];
+  const long double c = std::cos(theta);
+  const long double s = std::sin(theta);
+  return {c * twist[0] - s * twist[1] +
+              twist[2] * params.base_frame_offset[1],
+          s * twist[0] + c * twist[1] -
+              twist[2] * params.base_frame_offset[0],
+          twist[2]};
+}
+
+std::array<long double, NR_WHEELS>
+reference_ik(const MecanumKinematicsParams &params, const BodyTwist &twist) {
+  return reference_mecanum_ik(
+      params, reference_base_to_center(
+                  params, {twist.linear_x, twist.linear_y, twist.angular_z}));
+}
+
+// pseudo-inverse of the mecanum Jacobian, then v_base = R(-theta) (v_center +
+// w x p_base)
+Twist reference_fk(const MecanumKinematicsParams &params,
+                   const WheelVelocities &wheels) {
+  const long double r = params.wheels_radius;
+  const long double l = params.sum_of_robot_center_projection_on_X_Y_axis;
+  const long double fl = wheels[0], fr = wheels[1], rr = wheels[2],
+                    rl = wheels[3];
+  const long double vx = r / 4 * (fl + fr + rr + rl);
+  const long double vy = r / 4 * (-fl + fr - rr + rl);
+  const long double wz = r / (4 * l) * (-fl + fr + rr - rl);
+
+  const long double theta = params.base_frame_offset[2];
+  const long double c = std::cos(theta);
+  const long double s = std::sin(theta);
+  const long double px = vx - wz * params.base_frame_offset[1];
+  const long double py = vy + wz * params.base_frame_offset[0];
+  return {c * px + s * py, -s * px + c * py, wz};
+}
+
+// |actual - expected| within `ulps` of the magnitude of the summed terms.
+// Subnormal intermediates round to an absolute `DENORM_MIN`, which the
+// following operations scale by up to `underflow_gain`.
+bool is_close(const double actual, const long double expected,
+              const long double magnitude, const double ulps = 32.0,
+              const double underflow_gain = 1.0) {
+  if (std::isnan(actual) || std::isnan(static_cast<double>(expected))) {
+    return std::isnan(actual) && std::isnan(static_cast<double>(expected));
+  }
+  return std::abs(actual - expected) <=
+         ulps * EPSILON * magnitude + 64 * DENORM_MIN * underflow_gain;
+}
+
+class Generator {
+public:
+  explicit Generator(const std::uint64_t seed) : engine_(seed) {}
+
+  // log-uniform magnitude
+  double positive(const double min, const double max) {
+    return std::exp(std::uniform_real_distribution<double>(
+        std::log(min), std::log(max))(engine_));
+  }
+
+  double uniform(const double bound) {
+    return std::uniform_real_distribution<double>(-bound, bound)(engine_);
+  }
+
+  std::size_t pick(const std::size_t count) {
+    return std::uniform_int_distribution<std::size_t>(0, count - 1)(engine_);
+  }
+
+  MecanumKinematicsParams geometry() {
+    MecanumKinematicsParams params;
+    // mostly realistic, sometimes close to a zero radius
+    params.wheels_radius =
+        pick(10) == 0 ? positive(1e-15, 1e-9) : positive(1e-3, 10.0);
+    params.sum_of_robot_center_projection_on_X_Y_axis =
+        positive(1e-3, 1e3);
+    switch (pick(4)) {
+    case 0:
+      params.base_frame_offset = {0.0, 0.0, 0.0};
+      break;
+    case 1:
+      // large offsets
+      params.base_frame_offset = {uniform(1e6), uniform(1e6), uniform(1e3)};
+      break;
+    default:
+      params.base_frame_offset = {uniform(2.0), uniform(2.0), uniform(M_PI)};
+      break;
+    }
+    return params;
+  }
+
+  double velocity() {
+    switch (pick(8)) {
+    case 0:
+      return 0.0;
+    case 1:
+      // denormals
+      return uniform(1.0) * 1e4 * DENORM_MIN;
+    case 2:
+      return uniform(1e6);
+    default:
+      return uniform(10.0);
+    }
+  }
+
+private:
+  std::mt19937_64 engine_;
+};
+
+double ik_magnitude(const MecanumKinematicsParams &params,
+                    const BodyTwist &twist) {
+  return (std::abs(twist.linear_x) + std::abs(twist.linear_y) +
+          std::abs(twist.angular_z) *
+              (std::abs(params.base_frame_offset[0]) +
+               std::abs(params.base_frame_offset[1]) +
+               params.sum_of_robot_center_projection_on_X_Y_axis)) /
+         params.wheels_radius;
+}
+
+double fk_magnitude(const MecanumKinematicsParams &params,
+                    const WheelVelocities &wheels) {
+  double sum = 0.0;
+  for (const double wheel : wheels) {
+    sum += std::abs(wheel);
+  }
+  return params.wheels_radius * sum *
+         (2.0 + (1.0 + std::abs(params.base_frame_offset[0]) +
+                 std::abs(params.base_frame_offset[1])) /
+                    params.sum_of_robot_center_projection_on_X_Y_axis);
+}
+
+// intermediates are divided by the radius
+double ik_underflow_gain(const MecanumKinematicsParams &params) {
+  return 1.0 + 1.0 / params.wheels_radius;
+}
+
+// intermediates are multiplied by the offsets
+double fk_underflow_gain(const MecanumKinematicsParams &params) {
+  return 1.0 + std::abs(params.base_frame_offset[0]) +
+         std::abs(params.base_frame_offset[1]);
+}
+
+} // namespace
+
+TEST(KinematicsOracleTest, when_random_twists_expect_ik_matches_reference) {
+  Generator generator(1);
+  for (std::size_t n = 0; n < NR_CASES; ++n) {
+    const auto params = generator.geometry();
+    const BodyTwist twist{generator.velocity(), generator.velocity(),
+                          generator.velocity()};
+    const auto wheels =
+        mecanum_drive_controller::inverse_kinematics(params, twist);
+    const auto expected = reference_ik(params, twist);
+    const double magnitude = ik_magnitude(params, twist);
+    for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+      if (!is_close(wheels[i], expected[i], magnitude, 32.0,
+                    ik_underflow_gain(params))) {
+        FAIL() << "case " << n << ", wheel " << i << ": " << wheels[i]
+               << " != " << static_cast<double>(expected[i]);
+      }
+    }
+  }
+}
+
+TEST(KinematicsOracleTest, when_random_wheels_expect_fk_matches_reference) {
+  Generator generator(2);
+  for (std::size_t n = 0; n < NR_CASES; ++n) {
+    const auto params = generator.geometry();
+    const WheelVelocities wheels{generator.velocity(), generator.velocity(),
+                                 generator.velocity(), generator.velocity()};
+    const auto twist =
+        mecanum_drive_controller::forward_kinematics(params, wheels);
+    const auto expected = reference_fk(params, wheels);
+    const double magnitude = fk_magnitude(params, wheels);
+    const double actual[3] = {twist.linear_x, twist.linear_y,
+                              twist.angular_z};
+    for (std::size_t i = 0; i < 3; ++i) {
+      if (!is_close(actual[i], expected[i], magnitude, 32.0,
+                    fk_underflow_gain(params))) {
+        FAIL() << "case " << n << ", component " << i << ": " << actual[i]
+               << " != " << static_cast<double>(expected[i]);
+      }
+    }
+  }
+}
+
+TEST(KinematicsOracleTest, when_point_given_expect_twist_matches_reference) {
+  Generator generator(3);
+  for (std::size_t n = 0; n < NR_CASES; ++n) {
+    const BodyTwist twist{generator.velocity(), generator.velocity(),
+                          generator.velocity()};
+    const double x = generator.uniform(1e3);
+    const double y = generator.uniform(1e3);
+    const auto converted =
+        mecanum_drive_controller::twist_about_point(twist, x, y);
+    // v_base = v_point + w x (p_base - p_point)
+    const long double expected_x =
+        static_cast<long double>(twist.linear_x) +
+        static_cast<long double>(twist.angular_z) * y;
+    const long double expected_y =
+        static_cast<long double>(twist.linear_y) -
+        static_cast<long double>(twist.angular_z) * x;
+    const double magnitude = std::abs(twist.linear_x) +
+                             std::abs(twist.linear_y) +
+                             std::abs(twist.angular_z) *
+                                 (std::abs(x) + std::abs(y));
+    if (!is_close(converted.linear_x, expected_x, magnitude, 2.0) ||
+        !is_close(converted.linear_y, expected_y, magnitude, 2.0) ||
+        converted.angular_z != twist.angular_z) {
+      FAIL() << "case " << n;
+    }
+  }
+}
+
+// the batch kernels process samples of mixed geometry the same as one by one
+TEST(KinematicsOracleTest, when_batched_expect_same_as_reference) {
+  Generator generator(4);
+  std::vector<double> twists;
+  std::vector<double> wheel_velocities;
+  std::vector<double> output;
+  std::vector<double> dts;
+  std::vector<double> poses;
+  for (std::size_t n = 0; n < NR_CASES / 64; ++n) {
+    const auto params = generator.geometry();
+    const std::size_t count = 1 + generator.pick(64);
+
+    twists.resize(3 * count);
+    for (auto &value : twists) {
+      value = generator.velocity();
+    }
+    output.resize(NR_WHEELS * count);
+    mecanum_drive_controller::inverse_kinematics_batch(
+        params, twists.data(), count, output.data());
+    for (std::size_t k = 0; k < count; ++k) {
+      const BodyTwist twist{twists[3 * k], twists[3 * k + 1],
+                            twists[3 * k + 2]};
+      const auto expected = reference_ik(params, twist);
+      for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+        if (!is_close(output[NR_WHEELS * k + i], expected[i],
+                      ik_magnitude(params, twist), 32.0,
+                      ik_underflow_gain(params))) {
+          FAIL() << "IK case " << n << ", sample " << k << ", wheel " << i;
+        }
+      }
+    }
+
+    wheel_velocities.resize(NR_WHEELS * count);
+    for (auto &value : wheel_velocities) {
+      value = generator.velocity();
+    }
+    output.resize(3 * count);
+    mecanum_drive_controller::forward_kinematics_batch(
+        params, wheel_velocities.data(), count, output.data());
+    for (std::size_t k = 0; k < count; ++k) {
+      const WheelVelocities wheels{
+          wheel_velocities[NR_WHEELS * k], wheel_velocities[NR_WHEELS * k + 1],
+          wheel_velocities[NR_WHEELS * k + 2],
+          wheel_velocities[NR_WHEELS * k + 3]};
+      const auto expected = reference_fk(params, wheels);
+      for (std::size_t i = 0; i < 3; ++i) {
+        if (!is_close(output[3 * k + i], expected[i],
+                      fk_magnitude(params, wheels), 32.0,
+                      fk_underflow_gain(params))) {
+          FAIL() << "FK case " << n << ", sample " << k << ", component "
+                 << i;
+        }
+      }
+    }
+
+    // odometry: NaN samples keep the pose and the last twist
+    if (generator.pick(4) == 0) {
+      wheel_velocities[NR_WHEELS * generator.pick(count) + generator.pick(4)] =
+          std::numeric_limits<double>::quiet_NaN();
+    }
+    dts.resize(count);
+    for (auto &dt : dts) {
+      dt = generator.positive(1e-4, 0.1);
+    }
+    poses.resize(3 * count);
+    Pose2D pose;
+    mecanum_drive_controller::integrate_odometry_batch(
+        params, pose, wheel_velocities.data(), dts.data(), count,
+        poses.data(), output.data());
+    Pose2D expected_pose;
+    BodyTwist expected_twist;
+    for (std::size_t k = 0; k < count; ++k) {
+      const double *w = &wheel_velocities[NR_WHEELS * k];
+      if (!std::isnan(w[0] + w[1] + w[2] + w[3])) {
+        expected_twist = mecanum_drive_controller::forward_kinematics(
+            params, {w[0], w[1], w[2], w[3]});
+        mecanum_drive_controller::integrate_pose(expected_pose,
+                                                 expected_twist, dts[k]);
+      }
+      if (poses[3 * k] != expected_pose.x ||
+          poses[3 * k + 1] != expected_pose.y ||
+          poses[3 * k + 2] != expected_pose.rz ||
+          output[3 * k] != expected_twist.linear_x ||
+          output[3 * k + 1] != expected_twist.linear_y ||
+          output[3 * k + 2] != expected_twist.angular_z) {
+        FAIL() << "odometry case " << n << ", sample " << k;
+      }
+    }
+    EXPECT_EQ(pose.x, expected_pose.x);
+    EXPECT_EQ(pose.y, expected_pose.y);
+    EXPECT_EQ(pose.rz, expected_pose.rz);
+  }
+}
+
+// the precomputed coupled IK and least-squares FK against the stacked
+// Jacobian and its normal equations solved in extended precision
+TEST(KinematicsOracleTest, when_bases_coupled_expect_matches_reference) {
+  Generator generator(5);
+  for (std::size_t n = 0; n < NR_CASES / 10; ++n) {
+    MecanumKinematicsParams params;
+    params.wheels_radius = generator.positive(1e-2, 1.0);
+    params.sum_of_robot_center_projection_on_X_Y_axis =
+        generator.positive(0.1, 10.0);
+    params.base_frame_offset = {generator.uniform(1.0), generator.uniform(1.0),
+                                generator.uniform(M_PI)};
+    const std::array<Pose2D, NR_COUPLED_BASES> poses = {
+        Pose2D(), Pose2D{generator.uniform(10.0), generator.uniform(10.0),
+                         generator.uniform(M_PI)}};
+    CoupledKinematics kinematics;
+    ASSERT_TRUE(kinematics.configure({params, params}, poses));
+
+    // stacked Jacobian: IK of the carrier twist moved to each base frame
+    long double jacobian[NR_COUPLED_WHEELS][3];
+    for (std::size_t k = 0; k < 3; ++k) {
+      const Twist unit = {k == 0 ? 1.0L : 0.0L, k == 1 ? 1.0L : 0.0L,
+                          k == 2 ? 1.0L : 0.0L};
+      for (std::size_t base = 0; base < NR_COUPLED_BASES; ++base) {
+        const long double rz = poses[base].rz;
+        const long double c = std::cos(rz);
+        const long double s = std::sin(rz);
+        const long double vx = unit[0] - unit[2] * poses[base].y;
+        const long double vy = unit[1] + unit[2] * poses[base].x;
+        const auto wheels = reference_mecanum_ik(
+            params, reference_base_to_center(
+                        params, {c * vx + s * vy, -s * vx + c * vy, unit[2]}));
+        for (std::size_t i = 0; i < NR_WHEELS; ++i) {
+          jacobian[NR_WHEELS * base + i][k] = wheels[i];
+        }
+      }
+    }
+
+    const BodyTwist twist{generator.uniform(10.0), generator.uniform(10.0),
+                          generator.uniform(10.0)};
+    const auto wheels = kinematics.inverse(twist);
+    for (std::size_t i = 0; i < NR_COUPLED_WHEELS; ++i) {
+      const long double expected = jacobian[i][0] * twist.linear_x +
+                                   jacobian[i][1] * twist.linear_y +
+                                   jacobian[i][2] * twist.angular_z;
+      const double magnitude = std::abs(jacobian[i][0] * twist.linear_x) +
+                               std::abs(jacobian[i][1] * twist.linear_y) +
+                               std::abs(jacobian[i][2] * twist.angular_z);
+      if (!is_close(wheels[i], expected, magnitude, 1e3)) {
+        FAIL() << "case " << n << ", wheel " << i << ": " << wheels[i]
+               << " != " << static_cast<double>(expected);
+      }
+    }
+
+    CoupledWheelVelocities measured;
+    for (auto &wheel : measured) {
+      wheel = generator.uniform(100.0);
+    }
+    // normal equations J^T J t = J^T w by Gaussian elimination
+    long double system[3][4] = {};
+    for (std::size_t i = 0; i < NR_COUPLED_WHEELS; ++i) {
+      for (std::size_t r = 0; r < 3; ++r) {
+        for (std::size_t c = 0; c < 3; ++c) {
+          system[r][c] += jacobian[i][r] * jacobian[i][c];
+        }
+        system[r][3] += jacobian[i][r] * measured[i];
+      }
+    }
+    for (std::size_t p = 0; p < 3; ++p) {
+      std::size_t pivot = p;
+      for (std::size_t r = p + 1; r < 3; ++r) {
+        if (std::abs(system[r][p]) > std::abs(system[pivot][p])) {
+          pivot = r;
+        }
+      }
+      std::swap(system[p], system[pivot]);
+      for (std::size_t r = 0; r < 3; ++r) {
+        if (r != p) {
+          const long double factor = system[r][p] / system[p][p];
+          for (std::size_t c = p; c < 4; ++c) {
+            system[r][c] -= factor * system[p][c];
+          }
+        }
+      }
+    }
+    const auto fused = kinematics.forward(measured);
+    const double actual[3] = {fused.linear_x, fused.linear_y,
+                              fused.angular_z};
+    double magnitude = 0.0;
+    for (const double wheel : measured) {
+      magnitude += std::abs(wheel);
+    }
+    magnitude *= params.wheels_radius;
+    for (std::size_t i = 0; i < 3; ++i) {
+      const long double expected = system[i][3] / system[i][i];
+      // the 3x3 inverse loses a few digits to the conditioning of J
+      if (!is_close(actual[i], expected, magnitude, 1e6)) {
+        FAIL() << "case " << n << ", component " << i << ": " << actual[i]
+               << " != " << static_cast<double>(expected);
+      }
+    }
+  }
+}
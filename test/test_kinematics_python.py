@@ -0,0 +1,107 @@
+# Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Checks the mecanum_kinematics bindings against the kinematics math."""
+
+import math
+
+import mecanum_kinematics as mk
+import numpy as np
+import pytest
+
+WHEELS_RADIUS = 0.05
+SUM_OF_PROJECTIONS = 0.5
+BASE_FRAME_OFFSET = (0.2, -0.1, 0.3)
+
+TWISTS = np.array([
+    [0.0, 0.0, 0.0],
+    [1.0, 0.0, 0.0],
+    [0.0, -0.5, 0.0],
+    [0.0, 0.0, 1.2],
+    [1.5, -0.4, 0.7],
+])
+
+
+def make_params():
+    return mk.KinematicsParams(WHEELS_RADIUS, SUM_OF_PROJECTIONS,
+                               BASE_FRAME_OFFSET)
+
+
+def expected_wheel_velocities(twist):
+    """Inverse kinematics of a body twist of the offset base frame."""
+    linear_x, linear_y, angular_z = twist
+    offset_x, offset_y, offset_theta = BASE_FRAME_OFFSET
+    cos_theta = math.cos(offset_theta)
+    sin_theta = math.sin(offset_theta)
+    center_x = (cos_theta * linear_x - sin_theta * linear_y +
+                offset_y * angular_z)
+    center_y = (sin_theta * linear_x + cos_theta * linear_y -
+                offset_x * angular_z)
+    rotation = SUM_OF_PROJECTIONS * angular_z
+    return np.array([
+        center_x - center_y - rotation,
+        center_x + center_y + rotation,
+        center_x - center_y + rotation,
+        center_x + center_y - rotation,
+    ]) / WHEELS_RADIUS
+
+
+def test_inverse_kinematics_matches_formula():
+    wheel_velocities = mk.inverse_kinematics(make_params(), TWISTS)
+    assert wheel_velocities.shape == (len(TWISTS), 4)
+    for twist, wheels in zip(TWISTS, wheel_velocities):
+        np.testing.assert_allclose(wheels, expected_wheel_velocities(twist),
+                                   rtol=1e-12, atol=1e-12)
+
+
+def test_forward_kinematics_inverts_inverse_kinematics():
+    params = make_params()
+    twists = mk.forward_kinematics(params,
+                                   mk.inverse_kinematics(params, TWISTS))
+    np.testing.assert_allclose(twists, TWISTS, rtol=1e-12, atol=1e-12)
+
+
+def test_integrate_odometry_matches_stepwise_integration():
+    params = make_params()
+    wheel_velocities = mk.inverse_kinematics(params, TWISTS)
+    # invalid samples keep the pose and the last twist
+    wheel_velocities = np.insert(wheel_velocities, 2, np.nan, axis=0)
+    dts = np.full(len(wheel_velocities), 0.1)
+    initial_pose = (1.0, -2.0, 0.5)
+
+    poses, twists = mk.integrate_odometry(params, wheel_velocities, dts,
+                                          initial_pose)
+
+    x, y, rz = initial_pose
+    twist = (0.0, 0.0, 0.0)
+    for i, wheels in enumerate(wheel_velocities):
+        if not np.isnan(wheels).any():
+            twist = mk.forward_kinematics(params, wheels.reshape(1, 4))[0]
+            cos_rz = math.cos(rz)
+            sin_rz = math.sin(rz)
+            rz += twist[2] * dts[i]
+            x += (cos_rz * twist[0] - sin_rz * twist[1]) * dts[i]
+            y += (sin_rz * twist[0] + cos_rz * twist[1]) * dts[i]
+        np.testing.assert_allclose(poses[i], (x, y, rz), rtol=1e-12,
+                                   atol=1e-12)
+        np.testing.assert_allclose(twists[i], twist, rtol=1e-12, atol=1e-12)
+    np.testing.assert_array_equal(poses[2], poses[1])
+
+
+def test_wrong_shapes_are_rejected():
+    params = make_params()
+    with pytest.raises(ValueError):
+        mk.inverse_kinematics(params, np.zeros((3, 4)))
+    with pytest.raises(ValueError):
+        mk.integrate_odometry(params, np.zeros((3, 4)), np.zeros(2))
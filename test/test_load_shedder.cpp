@@ -0,0 +1,43 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+
+#include "mecanum_drive_controller/load_shedder.hpp"
+
+TEST(LoadShedderTest, when_cycles_back_in_budget_expect_stages_restored) {
+  using mecanum_drive_controller::ShedStage;
+  mecanum_drive_controller::LoadShedder shedder;
+  EXPECT_FALSE(shedder.enabled());
+  EXPECT_TRUE(shedder.should_run(ShedStage::INTROSPECTION));
+
+  shedder.configure(std::chrono::milliseconds(1), 2, 3, 1);
+  shedder.update(std::chrono::milliseconds(2));
+  EXPECT_EQ(shedder.level(), 0u);
+  shedder.update(std::chrono::milliseconds(2));
+  EXPECT_EQ(shedder.level(), 1u);
+  EXPECT_FALSE(shedder.should_run(ShedStage::INTROSPECTION));
+  EXPECT_TRUE(shedder.should_run(ShedStage::TELEMETRY));
+  EXPECT_EQ(shedder.shed_count(ShedStage::INTROSPECTION), 1u);
+
+  shedder.update(std::chrono::microseconds(500));
+  shedder.update(std::chrono::microseconds(500));
+  EXPECT_EQ(shedder.level(), 1u);
+  shedder.update(std::chrono::microseconds(500));
+  EXPECT_EQ(shedder.level(), 0u);
+  EXPECT_TRUE(shedder.should_run(ShedStage::INTROSPECTION));
+  EXPECT_EQ(shedder.overrun_count(), 2u);
+}
@@ -14,6 +14,11 @@
 
 #include "test_mecanum_drive_controller.hpp"
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <limits>
 #include <memory>
 #include <string>
@@ -21,6 +26,8 @@
 #include <vector>
 
 #include "hardware_interface/types/hardware_interface_type_values.hpp"
+#include "mecanum_drive_controller/process_usage.hpp"
+#include "mecanum_drive_controller/telemetry_archive.hpp"
 
 using mecanum_drive_controller::NR_CMD_ITFS;
 using mecanum_drive_controller::NR_REF_ITFS;
@@ -174,7 +181,9 @@ TEST_F(MecanumDriveControllerTest,
   // reference_callback() is implicitly called when publish_commands() is called
   // reference_msg is published with provided time stamp when publish_commands(
   // time_stamp) is called
-  publish_commands(controller_->get_node()->now() - controller_->ref_timeout_ -
+  const auto ref_timeout =
+      rclcpp::Duration::from_nanoseconds(controller_->ref_timeout_nanoseconds_);
+  publish_commands(controller_->get_node()->now() - ref_timeout -
                    rclcpp::Duration::from_seconds(0.1));
   controller_->wait_for_commands(executor, std::chrono::milliseconds(80));
   ASSERT_EQ(old_timestamp,
@@ -277,8 +286,9 @@ TEST_F(MecanumDriveControllerTest,
   std::shared_ptr<ControllerReferenceMsg> msg =
       std::make_shared<ControllerReferenceMsg>();
 
-  msg->header.stamp = controller_->get_node()->now() -
-                      controller_->ref_timeout_ -
+  const auto ref_timeout =
+      rclcpp::Duration::from_nanoseconds(controller_->ref_timeout_nanoseconds_);
+  msg->header.stamp = controller_->get_node()->now() - ref_timeout -
                       rclcpp::Duration::from_seconds(0.1);
   msg->twist.linear.x = TEST_LINEAR_VELOCITY_X;
   msg->twist.linear.y = TEST_LINEAR_VELOCITY_y;
@@ -292,7 +302,8 @@ TEST_F(MecanumDriveControllerTest,
       (*(controller_->input_ref_.readFromNonRT()))->header.stamp;
 
   // age_of_last_command > ref_timeout_
-  ASSERT_FALSE(age_of_last_command <= controller_->ref_timeout_);
+  ASSERT_FALSE(age_of_last_command.nanoseconds() <=
+               controller_->ref_timeout_nanoseconds_);
   ASSERT_EQ((*(controller_->input_ref_.readFromRT()))->twist.linear.x,
             TEST_LINEAR_VELOCITY_X);
   ASSERT_EQ(controller_->update(controller_->get_node()->now(),
@@ -324,7 +335,8 @@ TEST_F(MecanumDriveControllerTest,
       (*(controller_->input_ref_.readFromNonRT()))->header.stamp;
 
   // age_of_last_command_2 < ref_timeout_
-  ASSERT_TRUE(age_of_last_command_2 <= controller_->ref_timeout_);
+  ASSERT_TRUE(age_of_last_command_2.nanoseconds() <=
+              controller_->ref_timeout_nanoseconds_);
   ASSERT_EQ((*(controller_->input_ref_.readFromRT()))->twist.linear.x,
             TEST_LINEAR_VELOCITY_X);
   ASSERT_EQ(controller_->update(controller_->get_node()->now(),
@@ -421,7 +433,7 @@ TEST_F(
   // set command statically
   joint_command_values_[1] = command_lin_x;
 
-  controller_->ref_timeout_ = rclcpp::Duration::from_seconds(0.0);
+  controller_->ref_timeout_nanoseconds_ = 0;
   std::shared_ptr<ControllerReferenceMsg> msg =
       std::make_shared<ControllerReferenceMsg>();
 
@@ -438,7 +450,8 @@ TEST_F(
       controller_->get_node()->now() -
       (*(controller_->input_ref_.readFromNonRT()))->header.stamp;
 
-  ASSERT_FALSE(age_of_last_command <= controller_->ref_timeout_);
+  ASSERT_FALSE(age_of_last_command.nanoseconds() <=
+               controller_->ref_timeout_nanoseconds_);
   ASSERT_EQ((*(controller_->input_ref_.readFromRT()))->twist.linear.x,
             TEST_LINEAR_VELOCITY_X);
   ASSERT_EQ(controller_->update(controller_->get_node()->now(),
@@ -473,7 +486,7 @@ TEST_F(
       std::isnan((*(controller_->input_ref_.readFromNonRT()))->twist.linear.y));
   EXPECT_TRUE(std::isnan(
       (*(controller_->input_ref_.readFromNonRT()))->twist.angular.z));
-  controller_->ref_timeout_ = rclcpp::Duration::from_seconds(0.0);
+  controller_->ref_timeout_nanoseconds_ = 0;
 
   // reference_callback() is called implicitly when publish_commands() is
   // called. reference_msg is published with provided time stamp when
@@ -493,10 +506,709 @@ TEST_F(
   EXPECT_EQ((*(controller_->input_ref_.readFromNonRT()))->twist.angular.z, 0.0);
 }
 
+// the odometry snapshot has to mirror the getters after each update and carry
+// the configured covariance
+TEST_F(MecanumDriveControllerTest,
+       when_odometry_is_updated_expect_consistent_snapshot) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+
+  const auto time = controller_->get_node()->now();
+  ASSERT_EQ(controller_->update(time, rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+
+  const auto snapshot = controller_->odometry_.getSnapshot();
+  EXPECT_EQ(snapshot.x, controller_->odometry_.getX());
+  EXPECT_EQ(snapshot.y, controller_->odometry_.getY());
+  EXPECT_EQ(snapshot.rz, controller_->odometry_.getRz());
+  EXPECT_EQ(snapshot.vx, controller_->odometry_.getVx());
+  EXPECT_EQ(snapshot.vy, controller_->odometry_.getVy());
+  EXPECT_EQ(snapshot.wz, controller_->odometry_.getWz());
+  EXPECT_GT(snapshot.x, 0.0);
+  // stamped with the update time, like the odometry message
+  EXPECT_EQ(snapshot.stamp_nanoseconds, time.nanoseconds());
+  EXPECT_EQ(snapshot.pose_covariance_diagonal[1], 7.0);
+  EXPECT_EQ(snapshot.twist_covariance_diagonal[5], 35.0);
+}
+
+// when every cycle overruns its budget, optional stages are dropped in order
+// while wheel commands are still written
+TEST_F(MecanumDriveControllerTest,
+       when_cycles_overrun_budget_expect_optional_stages_shed) {
+  using mecanum_drive_controller::ShedStage;
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  controller_->load_shedder_.configure(std::chrono::nanoseconds(1), 1, 1000,
+                                       4);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+
+  for (size_t i = 0; i < 20; ++i) {
+    controller_->reference_interfaces_[0] = 1.5;
+    controller_->reference_interfaces_[1] = 0.0;
+    controller_->reference_interfaces_[2] = 0.0;
+    ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                  rclcpp::Duration::from_seconds(0.01)),
+              controller_interface::return_type::OK);
+    EXPECT_EQ(joint_command_values_[1], 3.0);
+  }
+
+  EXPECT_EQ(controller_->load_shedder_.level(),
+            mecanum_drive_controller::NR_SHED_STAGES);
+  EXPECT_EQ(controller_->load_shedder_.overrun_count(), 20u);
+  // introspection is shed from the 2nd cycle on
+  EXPECT_EQ(controller_->load_shedder_.shed_count(ShedStage::INTROSPECTION),
+            19u);
+  // controller_state is shed from the 4th cycle on
+  EXPECT_EQ(
+      controller_->load_shedder_.shed_count(ShedStage::CONTROLLER_STATE), 17u);
+  // odometry is decimated from the 5th cycle on, 1 out of 4 is published
+  EXPECT_EQ(
+      controller_->load_shedder_.shed_count(ShedStage::ODOMETRY_DECIMATION),
+      12u);
+}
+
+// frames from the raw socket go through the same checks as `~/reference`
+TEST_F(MecanumDriveControllerTest,
+       when_socket_frame_received_expect_reference_set) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+
+  mecanum_drive_controller::ReferenceFrame frame;
+  frame.sequence = 1;
+  frame.linear_x = 1.5;
+  frame.linear_y = 0.5;
+  frame.angular_z = 0.25;
+  controller_->socket_reference_callback(frame);
+
+  auto reference = *(controller_->input_ref_.readFromNonRT());
+  EXPECT_EQ(reference->twist.linear.x, 1.5);
+  EXPECT_EQ(reference->twist.linear.y, 0.5);
+  EXPECT_EQ(reference->twist.angular.z, 0.25);
+  EXPECT_NE(rclcpp::Time(reference->header.stamp).nanoseconds(), 0);
+
+  // too old frames are rejected
+  frame.stamp_nanoseconds =
+      (controller_->get_node()->now() - rclcpp::Duration::from_seconds(1.0))
+          .nanoseconds();
+  frame.linear_x = 3.0;
+  controller_->socket_reference_callback(frame);
+  EXPECT_EQ((*(controller_->input_ref_.readFromNonRT()))->twist.linear.x, 1.5);
+}
+
+// with obstacle speed limiting enabled, the commanded velocity is capped so the
+// robot stops within the free distance, and stopped without distances
+TEST_F(MecanumDriveControllerTest,
+       when_obstacle_close_expect_velocity_limited_to_braking_distance) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  controller_->params_.obstacle_speed_limit.enable = true;
+  controller_->params_.obstacle_speed_limit.deceleration_x = 2.0;
+  controller_->params_.obstacle_speed_limit.stop_margin = 0.0;
+  controller_->params_.obstacle_speed_limit.reaction_time = 0.0;
+
+  const auto update_with_reference = [&](const double linear_x) {
+    controller_->reference_interfaces_[0] = linear_x;
+    controller_->reference_interfaces_[1] = 0.0;
+    controller_->reference_interfaces_[2] = 0.0;
+    ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                  rclcpp::Duration::from_seconds(0.0)),
+              controller_interface::return_type::OK);
+  };
+
+  // no distances received yet
+  update_with_reference(1.5);
+  EXPECT_EQ(joint_command_values_[1], 0.0);
+
+  mecanum_drive_controller::ObstacleDistances distances;
+  distances.stamp_nanoseconds = controller_->get_node()->now().nanoseconds();
+  distances.front = 0.25;
+  controller_->obstacle_distances_.store(distances);
+
+  // v = sqrt(2 * 2.0 * 0.25) = 1.0, w = 1.0 / 0.5
+  update_with_reference(1.5);
+  EXPECT_NEAR(joint_command_values_[1], 2.0, EPS);
+
+  // no obstacle behind the robot
+  update_with_reference(-1.5);
+  EXPECT_NEAR(joint_command_values_[1], -3.0, EPS);
+}
+
+// invalid wheel states stop the wheels, once they are valid again the
+// controller recovers without a lifecycle transition
+TEST_F(MecanumDriveControllerTest,
+       when_wheel_state_nan_expect_fault_and_in_place_recovery) {
+  using mecanum_drive_controller::ControllerMode;
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  controller_->fault_monitor_.configure(true, 2, 0.0, 0.0, 1);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+
+  const auto update_with_reference = [&]() {
+    controller_->reference_interfaces_[0] = 1.5;
+    controller_->reference_interfaces_[1] = 0.0;
+    controller_->reference_interfaces_[2] = 0.0;
+    ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                  rclcpp::Duration::from_seconds(0.01)),
+              controller_interface::return_type::OK);
+  };
+
+  update_with_reference();
+  EXPECT_EQ(controller_->fault_monitor_.mode(), ControllerMode::RUNNING);
+  EXPECT_EQ(joint_command_values_[1], 3.0);
+
+  joint_state_values_[2] = std::numeric_limits<double>::quiet_NaN();
+  update_with_reference();
+  EXPECT_EQ(controller_->fault_monitor_.mode(), ControllerMode::FAULT);
+  EXPECT_EQ(joint_command_values_[1], 0.0);
+
+  joint_state_values_[2] = 0.1;
+  update_with_reference();
+  EXPECT_EQ(controller_->fault_monitor_.mode(), ControllerMode::FAULT);
+  EXPECT_EQ(joint_command_values_[1], 0.0);
+  update_with_reference();
+  EXPECT_EQ(controller_->fault_monitor_.mode(), ControllerMode::RECOVERING);
+  EXPECT_EQ(joint_command_values_[1], 0.0);
+  update_with_reference();
+  EXPECT_EQ(controller_->fault_monitor_.mode(), ControllerMode::RUNNING);
+  EXPECT_EQ(joint_command_values_[1], 3.0);
+  EXPECT_EQ(controller_->fault_monitor_.fault_count(), 1u);
+}
+
+// a timed-out reference degrades the controller once, afterwards there is no
+// reference and the parked robot is not held in DEGRADED
+TEST_F(MecanumDriveControllerTest,
+       when_reference_timed_out_and_parked_expect_running) {
+  using mecanum_drive_controller::ControllerMode;
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+
+  std::shared_ptr<ControllerReferenceMsg> msg =
+      std::make_shared<ControllerReferenceMsg>();
+  const auto ref_timeout =
+      rclcpp::Duration::from_nanoseconds(controller_->ref_timeout_nanoseconds_);
+  msg->header.stamp = controller_->get_node()->now() - ref_timeout -
+                      rclcpp::Duration::from_seconds(0.1);
+  msg->twist.linear.x = TEST_LINEAR_VELOCITY_X;
+  msg->twist.linear.y = TEST_LINEAR_VELOCITY_y;
+  msg->twist.angular.z = TEST_ANGULAR_VELOCITY_Z;
+  controller_->input_ref_.writeFromNonRT(msg);
+
+  ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+  EXPECT_EQ(controller_->fault_monitor_.mode(), ControllerMode::DEGRADED);
+  EXPECT_EQ(joint_command_values_[1], 0.0);
+
+  for (size_t n = 0; n < 5; ++n) {
+    ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                  rclcpp::Duration::from_seconds(0.01)),
+              controller_interface::return_type::OK);
+    EXPECT_EQ(controller_->fault_monitor_.mode(), ControllerMode::RUNNING);
+    EXPECT_EQ(joint_command_values_[1], 0.0);
+  }
+}
+
+TEST_F(MecanumDriveControllerTest,
+       when_telemetry_recorded_expect_cycles_in_archive) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  const std::string path = "/tmp/test_mecanum_drive_controller_" +
+                           std::to_string(::getpid()) + ".mdta";
+  controller_->telemetry_recorder_ =
+      std::make_unique<mecanum_drive_controller::TelemetryRecorder>();
+  ASSERT_TRUE(controller_->telemetry_recorder_->start(path, 64, 4));
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+
+  for (size_t n = 0; n < 10; ++n) {
+    controller_->reference_interfaces_[0] = 1.5;
+    controller_->reference_interfaces_[1] = 0.0;
+    controller_->reference_interfaces_[2] = 0.0;
+    ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                  rclcpp::Duration::from_seconds(0.01)),
+              controller_interface::return_type::OK);
+  }
+  controller_->telemetry_recorder_->stop();
+
+  mecanum_drive_controller::TelemetryArchiveReader reader;
+  ASSERT_TRUE(reader.open(path));
+  std::vector<mecanum_drive_controller::TelemetrySample> samples;
+  ASSERT_TRUE(reader.read(
+      std::numeric_limits<std::int64_t>::min(),
+      std::numeric_limits<std::int64_t>::max(),
+      [&](const mecanum_drive_controller::TelemetrySample &sample) {
+        samples.push_back(sample);
+      }));
+  std::remove(path.c_str());
+
+  ASSERT_EQ(samples.size(), 10u);
+  using mecanum_drive_controller::FRONT_RIGHT_COMMAND;
+  using mecanum_drive_controller::FRONT_RIGHT_STATE;
+  EXPECT_NEAR(samples.back().values[FRONT_RIGHT_STATE], 0.1, 1e-4);
+  EXPECT_NEAR(samples.back().values[FRONT_RIGHT_COMMAND], 3.0, 1e-4);
+  EXPECT_GT(samples.back().stamp_nanoseconds,
+            samples.front().stamp_nanoseconds);
+}
+
+TEST_F(MecanumDriveControllerTest,
+       when_velocity_estimation_enabled_expect_velocities_from_positions) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  controller_->params_.velocity_estimation.enable = true;
+  controller_->velocity_estimator_.configure(1, 8, 0.04);
+  for (const auto &name :
+       controller_->state_interface_configuration().names) {
+    EXPECT_EQ(name.substr(name.rfind('/') + 1),
+              hardware_interface::HW_IF_POSITION);
+  }
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+
+  // all wheels creep forward by one 0.02 rad tick every 4 cycles (0.5 rad/s)
+  std::fill(joint_state_values_.begin(), joint_state_values_.end(), 0.0);
+  for (size_t n = 0; n < 40; ++n) {
+    std::fill(joint_state_values_.begin(), joint_state_values_.end(),
+              0.02 * static_cast<double>(n / 4));
+    ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                  rclcpp::Duration::from_seconds(0.01)),
+              controller_interface::return_type::OK);
+  }
+
+  EXPECT_EQ(controller_->velocity_estimator_.window(0), 8u);
+  // wheels radius is 0.5 m
+  EXPECT_NEAR(controller_->odometry_.getVx(), 0.25, 1e-9);
+  EXPECT_NEAR(controller_->odometry_.getVy(), 0.0, 1e-9);
+  EXPECT_NEAR(controller_->odometry_.getWz(), 0.0, 1e-9);
+}
+
+TEST_F(MecanumDriveControllerTest,
+       when_state_decimated_expect_statistics_over_publish_window) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  controller_->params_.controller_state_decimation = 4;
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+
+  for (size_t n = 0; n < 4; ++n) {
+    // a one-cycle spike of the front left wheel
+    joint_state_values_[0] = n == 1 ? 5.0 : 0.1;
+    controller_->reference_interfaces_[0] = 1.5;
+    controller_->reference_interfaces_[1] = 0.0;
+    controller_->reference_interfaces_[2] = 0.0;
+    ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                  rclcpp::Duration::from_seconds(0.01)),
+              controller_interface::return_type::OK);
+    EXPECT_EQ(controller_->controller_state_cycle_, n < 3 ? n + 1 : 0u);
+  }
+
+  const auto &data = controller_->state_statistics_publisher_->msg_.data;
+  ASSERT_EQ(data.size(),
+            3 * mecanum_drive_controller::NR_STATE_STATISTICS_SIGNALS);
+  // front left wheel state: min, max, mean
+  EXPECT_DOUBLE_EQ(data[0], 0.1);
+  EXPECT_DOUBLE_EQ(data[1], 5.0);
+  EXPECT_DOUBLE_EQ(data[2], (3 * 0.1 + 5.0) / 4);
+  // front right wheel command
+  EXPECT_DOUBLE_EQ(data[3 * (NR_STATE_ITFS + 1)], 3.0);
+  EXPECT_DOUBLE_EQ(data[3 * (NR_STATE_ITFS + 1) + 1], 3.0);
+  // reference linear x mean
+  EXPECT_DOUBLE_EQ(data[3 * (NR_STATE_ITFS + NR_CMD_ITFS) + 2], 1.5);
+  // the window restarts after publishing
+  EXPECT_EQ(controller_->state_statistics_.count(0), 0u);
+}
+
+// a busy publisher and NaN wheel states are counted and exported
+TEST_F(MecanumDriveControllerTest,
+       when_publisher_busy_expect_dropped_publish_counted) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+
+  controller_->rt_odom_state_publisher_->lock();
+  ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+  controller_->rt_odom_state_publisher_->unlock();
+
+  joint_state_values_[0] = std::numeric_limits<double>::quiet_NaN();
+  ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+
+  using mecanum_drive_controller::MetricsPublisher;
+  EXPECT_EQ(controller_->metrics_.cycles(), 2u);
+  EXPECT_EQ(controller_->metrics_.dropped_publishes(MetricsPublisher::ODOMETRY),
+            1u);
+  EXPECT_EQ(controller_->metrics_.invalid_wheel_states(), 1u);
+
+  const std::string text = controller_->metrics_.render_prometheus(
+      "test", controller_->load_shedder_, controller_->fault_monitor_);
+  EXPECT_NE(text.find("mecanum_drive_controller_cycles_total"
+                      "{controller=\"test\"} 2\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("mecanum_drive_controller_dropped_publishes_total"
+                      "{controller=\"test\",publisher=\"odometry\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("mecanum_drive_controller_mode"
+                      "{controller=\"test\",mode=\"FAULT\"} 1\n"),
+            std::string::npos);
+}
+
+// topic references are counted by their age when applied, chained ones
+// carry no stamp and are not counted
+TEST_F(MecanumDriveControllerTest,
+       when_reference_applied_expect_age_in_histogram_if_stamped) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  controller_->set_chained_mode(false);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  ASSERT_NE(controller_->reference_age_publisher_, nullptr);
+
+  const auto now = controller_->get_node()->now();
+  std::shared_ptr<ControllerReferenceMsg> msg =
+      std::make_shared<ControllerReferenceMsg>();
+  msg->header.stamp = now - rclcpp::Duration::from_seconds(0.03);
+  msg->twist.linear.x = TEST_LINEAR_VELOCITY_X;
+  msg->twist.linear.y = TEST_LINEAR_VELOCITY_y;
+  msg->twist.angular.z = TEST_ANGULAR_VELOCITY_Z;
+  controller_->input_ref_.writeFromNonRT(msg);
+  ASSERT_EQ(
+      controller_->update(now, rclcpp::Duration::from_seconds(0.01)),
+      controller_interface::return_type::OK);
+
+  using mecanum_drive_controller::ReferenceInput;
+  const auto &topic_ages =
+      controller_->metrics_.reference_ages(ReferenceInput::TOPIC);
+  EXPECT_EQ(topic_ages.count(), 1u);
+  // up to 50 ms
+  EXPECT_EQ(topic_ages.bucket(5), 1u);
+  EXPECT_EQ(topic_ages.sum_nanoseconds(), 30000000u);
+
+  ASSERT_EQ(controller_->on_deactivate(rclcpp_lifecycle::State()),
+            NODE_SUCCESS);
+  controller_->set_chained_mode(true);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  controller_->reference_interfaces_[0] = 1.5;
+  controller_->reference_interfaces_[1] = 0.0;
+  controller_->reference_interfaces_[2] = 0.0;
+  ASSERT_EQ(
+      controller_->update(now, rclcpp::Duration::from_seconds(0.01)),
+      controller_interface::return_type::OK);
+
+  EXPECT_EQ(topic_ages.count(), 1u);
+}
+
+// a rotation about the chained rotation center moves the base around it
+TEST_F(MecanumDriveControllerTest,
+       when_rotation_center_set_expect_rotation_about_it) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  controller_->set_chained_mode(true);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  ASSERT_EQ(controller_->reference_interfaces_.size(),
+            NR_REF_ITFS + mecanum_drive_controller::NR_ROTATION_CENTER_ITFS +
+                mecanum_drive_controller::NR_MAP_CORRECTION_ITFS);
+
+  // rotate about a point 1 m ahead of the base frame
+  controller_->reference_interfaces_[0] = 0.0;
+  controller_->reference_interfaces_[1] = 0.0;
+  controller_->reference_interfaces_[2] = 1.0;
+  controller_->reference_interfaces_[mecanum_drive_controller::
+                                         ROTATION_CENTER_X] = 1.0;
+  controller_->reference_interfaces_[mecanum_drive_controller::
+                                         ROTATION_CENTER_Y] = 0.0;
+  ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+
+  // base twist (0, -1, 1): w = 1 / 0.5 * (vx -/+ vy -/+ 1 * wz)
+  EXPECT_DOUBLE_EQ(joint_command_values_[0], 0.0);
+  EXPECT_DOUBLE_EQ(joint_command_values_[1], 0.0);
+  EXPECT_DOUBLE_EQ(joint_command_values_[2], 4.0);
+  EXPECT_DOUBLE_EQ(joint_command_values_[3], -4.0);
+  for (const auto &interface : controller_->reference_interfaces_) {
+    EXPECT_TRUE(std::isnan(interface));
+  }
+
+  // an unset rotation center rotates about the base frame
+  controller_->reference_interfaces_[0] = 0.0;
+  controller_->reference_interfaces_[1] = 0.0;
+  controller_->reference_interfaces_[2] = 1.0;
+  ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+  EXPECT_DOUBLE_EQ(joint_command_values_[0], -2.0);
+  EXPECT_DOUBLE_EQ(joint_command_values_[1], 2.0);
+  EXPECT_DOUBLE_EQ(joint_command_values_[2], 2.0);
+  EXPECT_DOUBLE_EQ(joint_command_values_[3], -2.0);
+}
+
+// a parked base skips integration and publishes only at the heartbeat
+TEST_F(MecanumDriveControllerTest, when_parked_expect_idle_until_reference) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  controller_->idle_detector_.configure(3, 0.01, std::chrono::milliseconds(50));
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+
+  // creeping wheels below the standstill threshold, no reference
+  joint_state_values_ = {0.005, 0.005, 0.005, 0.005};
+  double idle_x = 0.0;
+  for (size_t n = 0; n < 9; ++n) {
+    ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                  rclcpp::Duration::from_seconds(0.01)),
+              controller_interface::return_type::OK);
+    EXPECT_EQ(controller_->idle_detector_.idle(), n >= 3);
+    if (n == 3) {
+      idle_x = controller_->odometry_.getX();
+      EXPECT_GT(idle_x, 0.0);
+    }
+    // the creeping twist is reported until the base goes idle
+    if (n < 3) {
+      EXPECT_GT(controller_->odometry_.getVx(), 0.0);
+    } else {
+      EXPECT_EQ(controller_->odometry_.getVx(), 0.0);
+      EXPECT_EQ(controller_->odometry_.getWz(), 0.0);
+    }
+    // the state is held back until the heartbeat after 50 ms of idling
+    EXPECT_EQ(controller_->controller_state_cycle_,
+              n < 3 || n == 8 ? 0u : n - 2);
+  }
+  EXPECT_EQ(controller_->odometry_.getX(), idle_x);
+  EXPECT_EQ(controller_->idle_detector_.idle_cycle_count(), 6u);
+
+  // the first nonzero reference wakes the controller up in the same cycle
+  controller_->reference_interfaces_[0] = 1.5;
+  controller_->reference_interfaces_[1] = 0.0;
+  controller_->reference_interfaces_[2] = 0.0;
+  ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+  EXPECT_FALSE(controller_->idle_detector_.idle());
+  EXPECT_EQ(joint_command_values_[1], 3.0);
+  EXPECT_GT(controller_->odometry_.getX(), idle_x);
+  EXPECT_EQ(controller_->controller_state_cycle_, 0u);
+}
+
+// the newest map->odom correction of the topic and the chained interfaces is
+// composed with the odometry at the decimated rate
+TEST_F(MecanumDriveControllerTest,
+       when_map_correction_received_expect_composed_map_pose) {
+  using mecanum_drive_controller::MAP_CORRECTION_RZ;
+  using mecanum_drive_controller::MAP_CORRECTION_X;
+  using mecanum_drive_controller::MAP_CORRECTION_Y;
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  controller_->params_.map_pose.enable = true;
+  controller_->params_.map_pose.decimation = 2;
+  controller_->map_pose_publisher_ =
+      std::make_unique<TestableMecanumDriveController::MapPosePublisher>(
+          controller_->get_node()
+              ->create_publisher<TestableMecanumDriveController::MapPoseMsg>(
+                  "~/map_pose", rclcpp::SystemDefaultsQoS()));
+  const auto &msg = controller_->map_pose_publisher_->msg_;
+
+  const auto update = [&]() {
+    ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                  rclcpp::Duration::from_seconds(0.01)),
+              controller_interface::return_type::OK);
+  };
+
+  // nothing is published before the first correction
+  update();
+  update();
+  EXPECT_EQ(controller_->last_map_correction_.stamp_nanoseconds, 0);
+  EXPECT_EQ(rclcpp::Time(msg.header.stamp).nanoseconds(), 0);
+
+  // odom is 1 m along x and 2 m along y of the map, turned by 90 degrees
+  mecanum_drive_controller::MapCorrection correction;
+  correction.stamp_nanoseconds = controller_->get_node()->now().nanoseconds();
+  correction.map_to_odom = {1.0, 2.0, M_PI / 2.0};
+  controller_->map_correction_.store(correction);
+  update();
+  EXPECT_GT(controller_->odometry_.getX(), 0.0);
+  EXPECT_NEAR(msg.pose.position.x, 1.0 - controller_->odometry_.getY(),
+              1e-12);
+  EXPECT_NEAR(msg.pose.position.y, 2.0 + controller_->odometry_.getX(),
+              1e-12);
+  EXPECT_NEAR(msg.pose.orientation.z, std::sin(M_PI / 4.0), 1e-12);
+  EXPECT_EQ(controller_->map_pose_cycle_, 0u);
+
+  // a newer chained correction replaces the one of the topic
+  controller_->reference_interfaces_[MAP_CORRECTION_X] = -1.0;
+  controller_->reference_interfaces_[MAP_CORRECTION_Y] = 0.0;
+  controller_->reference_interfaces_[MAP_CORRECTION_RZ] = 0.0;
+  update();
+  EXPECT_TRUE(
+      std::isnan(controller_->reference_interfaces_[MAP_CORRECTION_X]));
+  EXPECT_EQ(controller_->map_pose_cycle_, 1u);
+  update();
+  EXPECT_EQ(controller_->map_pose_cycle_, 0u);
+  EXPECT_NEAR(msg.pose.position.x, -1.0 + controller_->odometry_.getX(),
+              1e-12);
+  EXPECT_NEAR(msg.pose.position.y, controller_->odometry_.getY(), 1e-12);
+  EXPECT_NEAR(msg.pose.orientation.z, 0.0, 1e-12);
+}
+
+// the stages apply in the configured order and each measured cycle records
+// the duration of the whole pipeline
+TEST_F(MecanumDriveControllerTest,
+       when_reference_pipeline_configured_expect_processed_reference) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  mecanum_drive_controller::ReferencePipelineParams params;
+  params.scale = {2.0, 1.0, 1.0};
+  params.limit = {2.5, 0.0, 0.0};
+  params.deadband = {0.0, 0.0, 0.1};
+  ASSERT_TRUE(controller_->reference_pipeline_.configure(
+      {"deadband", "scale", "limit"}, params));
+  // a cycle budget times the cycles
+  controller_->load_shedder_.configure(std::chrono::seconds(1), 1, 1, 1);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+
+  controller_->reference_interfaces_[0] = 1.5;
+  controller_->reference_interfaces_[1] = 0.0;
+  controller_->reference_interfaces_[2] = 0.05;
+  ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+
+  // 1.5 m/s scaled to 3.0 m/s and limited to 2.5 m/s, no rotation
+  for (const double command : joint_command_values_) {
+    EXPECT_NEAR(command, 5.0, EPS);
+  }
+  EXPECT_EQ(controller_->metrics_.reference_pipeline_durations().count(), 1u);
+}
+
+// the publishers created on configure share one publishing thread, the
+// statistics stream is optional
+TEST_F(MecanumDriveControllerTest,
+       when_configured_expect_footprint_and_optional_statistics) {
+  SetUpController();
+
+  const auto usage_before = mecanum_drive_controller::sample_process_usage();
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  const auto footprint =
+      mecanum_drive_controller::sample_process_usage() - usage_before;
+  EXPECT_GT(footprint.heap_bytes, 0);
+  EXPECT_LE(footprint.threads, 1);
+  EXPECT_EQ(controller_->fault_state_publisher_, nullptr);
+  EXPECT_EQ(controller_->reset_fault_service_, nullptr);
+  RecordProperty(
+      "object_bytes",
+      static_cast<int>(
+          sizeof(mecanum_drive_controller::MecanumDriveController)));
+
+  // as if `controller_state_statistics` was not set
+  controller_->state_statistics_publisher_.reset();
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  controller_->reference_interfaces_[0] = 1.5;
+  controller_->reference_interfaces_[1] = 0.0;
+  controller_->reference_interfaces_[2] = 0.0;
+  ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+  EXPECT_EQ(joint_command_values_[1], 3.0);
+  EXPECT_EQ(controller_->controller_state_cycle_, 0u);
+  EXPECT_EQ(controller_->metrics_.dropped_publishes(
+                mecanum_drive_controller::MetricsPublisher::
+                    CONTROLLER_STATE_STATISTICS),
+            0u);
+}
+
+// the commands of a cycle are kept for its later readers and written to all
+// wheels in one pass, also when stopping
+TEST_F(MecanumDriveControllerTest,
+       when_updated_expect_commands_mirrored_and_written_once) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  ASSERT_EQ(controller_->nr_wheels_, joint_command_values_.size());
+
+  controller_->reference_interfaces_[0] = 1.5;
+  controller_->reference_interfaces_[1] = 0.0;
+  controller_->reference_interfaces_[2] = 0.0;
+  ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+  for (size_t i = 0; i < joint_command_values_.size(); ++i) {
+    EXPECT_EQ(joint_command_values_[i], 3.0);
+    EXPECT_EQ(controller_->wheel_commands_[i], joint_command_values_[i]);
+  }
+
+  // without a reference all wheels are stopped
+  ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+  for (size_t i = 0; i < joint_command_values_.size(); ++i) {
+    EXPECT_EQ(joint_command_values_[i], 0.0);
+    EXPECT_EQ(controller_->wheel_commands_[i], 0.0);
+  }
+
+  ASSERT_EQ(controller_->on_deactivate(rclcpp_lifecycle::State()),
+            NODE_SUCCESS);
+  for (size_t i = 0; i < joint_command_values_.size(); ++i) {
+    EXPECT_TRUE(std::isnan(joint_command_values_[i]));
+    EXPECT_TRUE(std::isnan(controller_->wheel_commands_[i]));
+  }
+}
+
+// the odometry sees no rotation of the wheels, the yaw rate loop raises the
+// commanded rotation until the base is stopped
+TEST_F(MecanumDriveControllerTest,
+       when_yaw_rate_feedback_enabled_expect_corrected_rotation) {
+  SetUpController();
+
+  ASSERT_EQ(controller_->on_configure(rclcpp_lifecycle::State()), NODE_SUCCESS);
+  controller_->params_.yaw_rate_feedback.enable = true;
+  controller_->yaw_rate_controller_.configure(1.0, 0.0, 0.0);
+  ASSERT_EQ(controller_->on_activate(rclcpp_lifecycle::State()), NODE_SUCCESS);
+
+  controller_->reference_interfaces_[0] = 0.0;
+  controller_->reference_interfaces_[1] = 0.0;
+  controller_->reference_interfaces_[2] = 0.5;
+  ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+
+  // 0.5 rad/s commanded, 0 rad/s measured
+  EXPECT_NEAR(controller_->yaw_rate_controller_.correction(), 0.5, EPS);
+  const auto expected = mecanum_drive_controller::inverse_kinematics(
+      controller_->kinematics_params_, {0.0, 0.0, 1.0});
+  for (size_t i = 0; i < joint_command_values_.size(); ++i) {
+    EXPECT_NEAR(joint_command_values_[i], expected[i], EPS);
+  }
+
+  // no reference stops the base and clears the loop
+  ASSERT_EQ(controller_->update(controller_->get_node()->now(),
+                                rclcpp::Duration::from_seconds(0.01)),
+            controller_interface::return_type::OK);
+  EXPECT_EQ(controller_->yaw_rate_controller_.correction(), 0.0);
+  EXPECT_EQ(joint_command_values_[0], 0.0);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   rclcpp::init(argc, argv);
   int result = RUN_ALL_TESTS();
   rclcpp::shutdown();
   return result;
-}
\ No newline at end of file
+}
+
@@ -88,6 +88,43 @@ class TestableMecanumDriveController
   FRIEND_TEST(
       MecanumDriveControllerTest,
       when_ref_timeout_zero_for_reference_callback_expect_reference_msg_being_used_only_once);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_odometry_is_updated_expect_consistent_snapshot);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_cycles_overrun_budget_expect_optional_stages_shed);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_socket_frame_received_expect_reference_set);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_obstacle_close_expect_velocity_limited_to_braking_distance);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_wheel_state_nan_expect_fault_and_in_place_recovery);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_reference_timed_out_and_parked_expect_running);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_telemetry_recorded_expect_cycles_in_archive);
+  FRIEND_TEST(
+      MecanumDriveControllerTest,
+      when_velocity_estimation_enabled_expect_velocities_from_positions);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_state_decimated_expect_statistics_over_publish_window);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_publisher_busy_expect_dropped_publish_counted);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_reference_applied_expect_age_in_histogram_if_stamped);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_rotation_center_set_expect_rotation_about_it);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_parked_expect_idle_until_reference);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_map_correction_received_expect_composed_map_pose);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_reference_pipeline_configured_expect_processed_reference);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_configured_expect_footprint_and_optional_statistics);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_updated_expect_commands_mirrored_and_written_once);
+  FRIEND_TEST(MecanumDriveControllerTest,
+              when_yaw_rate_feedback_enabled_expect_corrected_rotation);
 
 public:
   controller_interface::CallbackReturn
@@ -276,7 +313,10 @@ protected:
 
 protected:
   std::vector<std::string> reference_interface_names = {
-      "linear/x/velocity", "linear/y/velocity", "angular/z/velocity"};
+      "linear/x/velocity", "linear/y/velocity", "angular/z/velocity",
+      "rotation_center/x/position", "rotation_center/y/position",
+      "map_correction/x/position", "map_correction/y/position",
+      "map_correction/rz/position"};
 
   static constexpr char TEST_FRONT_LEFT_CMD_JOINT_NAME[] =
       "front_left_wheel_joint";
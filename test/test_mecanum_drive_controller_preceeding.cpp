@@ -53,8 +53,11 @@ TEST_F(MecanumDriveControllerTest,
             TEST_REAR_RIGHT_CMD_JOINT_NAME);
   ASSERT_EQ(controller_->params_.rear_left_wheel_command_joint_name,
             TEST_REAR_LEFT_CMD_JOINT_NAME);
-  ASSERT_THAT(controller_->command_joint_names_,
-              testing::ElementsAreArray(command_joint_names_));
+  ASSERT_EQ(controller_->nr_joint_names_, command_joint_names_.size());
+  ASSERT_THAT(command_joint_names_,
+              testing::ElementsAreArray(
+                  controller_->command_joint_names_.data(),
+                  controller_->nr_joint_names_));
   ASSERT_EQ(controller_->params_.front_left_wheel_state_joint_name,
             TEST_FRONT_LEFT_STATE_JOINT_NAME);
   ASSERT_EQ(controller_->params_.front_right_wheel_state_joint_name,
@@ -63,8 +66,9 @@ TEST_F(MecanumDriveControllerTest,
             TEST_REAR_RIGHT_STATE_JOINT_NAME);
   ASSERT_EQ(controller_->params_.rear_left_wheel_state_joint_name,
             TEST_REAR_LEFT_STATE_JOINT_NAME);
-  ASSERT_THAT(controller_->state_joint_names_,
-              testing::ElementsAreArray(state_joint_names_));
+  ASSERT_THAT(state_joint_names_,
+              testing::ElementsAreArray(controller_->state_joint_names_.data(),
+                                        controller_->nr_joint_names_));
 }
 
 TEST_F(MecanumDriveControllerTest,
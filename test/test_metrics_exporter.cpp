@@ -0,0 +1,95 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "mecanum_drive_controller/metrics_exporter.hpp"
+
+TEST(MetricsExporterTest, when_scraped_over_http_expect_rendered_metrics) {
+  using mecanum_drive_controller::MetricsExporter;
+  MetricsExporter exporter;
+  ASSERT_TRUE(exporter.start(MetricsExporter::Type::HTTP, "", 0,
+                             std::chrono::milliseconds(0),
+                             []() { return std::string("metric 1\n"); }))
+      << exporter.error();
+  ASSERT_NE(exporter.http_port(), 0u);
+
+  auto get = [&](const std::string &path) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(exporter.http_port());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    std::string response;
+    if (::connect(fd, reinterpret_cast<const sockaddr *>(&address),
+                  sizeof(address)) == 0) {
+      const std::string request = "GET " + path + " HTTP/1.1\r\n\r\n";
+      ::send(fd, request.data(), request.size(), 0);
+      char buffer[512];
+      ssize_t size;
+      while ((size = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<std::size_t>(size));
+      }
+    }
+    ::close(fd);
+    return response;
+  };
+
+  const std::string response = get("/metrics");
+  EXPECT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+  EXPECT_NE(response.find("Content-Length: 9\r\n"), std::string::npos);
+  EXPECT_EQ(response.substr(response.size() - 9), "metric 1\n");
+  EXPECT_EQ(get("/other").rfind("HTTP/1.1 404", 0), 0u);
+  EXPECT_EQ(exporter.export_count(), 1u);
+  exporter.stop();
+}
+
+TEST(MetricsExporterTest, when_stopped_expect_file_rewritten) {
+  using mecanum_drive_controller::MetricsExporter;
+  const std::string path = "/tmp/test_mecanum_drive_controller_" +
+                           std::to_string(::getpid()) + ".prom";
+  std::atomic<int> renders(0);
+  MetricsExporter exporter;
+  ASSERT_TRUE(exporter.start(MetricsExporter::Type::FILE, path, 0,
+                             std::chrono::milliseconds(10), [&]() {
+                               return "renders " +
+                                      std::to_string(++renders) + "\n";
+                             }))
+      << exporter.error();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  exporter.stop();
+
+  std::FILE *file = std::fopen(path.c_str(), "r");
+  ASSERT_NE(file, nullptr);
+  char buffer[64] = {};
+  std::fread(buffer, 1, sizeof(buffer) - 1, file);
+  std::fclose(file);
+  std::remove(path.c_str());
+  EXPECT_GT(renders.load(), 2);
+  EXPECT_EQ(std::string(buffer), "renders " + std::to_string(renders) + "\n");
+  EXPECT_FALSE(exporter.start(MetricsExporter::Type::FILE,
+                              "/nonexistent/metrics.prom", 0,
+                              std::chrono::milliseconds(10),
+                              []() { return std::string(); }));
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cmath>
+#include <limits>
+
+#include "mecanum_drive_controller/obstacle_speed_limit.hpp"
+
+TEST(ObstacleSpeedLimitTest, when_reaction_time_given_expect_stop_in_distance) {
+  using mecanum_drive_controller::braking_distance_speed_limit;
+  EXPECT_TRUE(std::isinf(braking_distance_speed_limit(
+      std::numeric_limits<double>::quiet_NaN(), 1.0, 0.1)));
+  EXPECT_EQ(braking_distance_speed_limit(-0.1, 1.0, 0.1), 0.0);
+
+  const double deceleration = 1.5;
+  const double reaction_time = 0.2;
+  const double limit =
+      braking_distance_speed_limit(2.0, deceleration, reaction_time);
+  EXPECT_NEAR(limit * reaction_time + limit * limit / (2.0 * deceleration),
+              2.0, 1e-9);
+
+  mecanum_drive_controller::ObstacleDistances distances;
+  distances.left = 0.5;
+  double linear_x = 0.3;
+  double linear_y = 5.0;
+  mecanum_drive_controller::limit_velocity_by_obstacle_distances(
+      distances, 1.0, 1.0, 0.0, 0.0, linear_x, linear_y);
+  EXPECT_EQ(linear_x, 0.3);
+  EXPECT_NEAR(linear_y, 1.0, 1e-9);
+}
@@ -0,0 +1,40 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "mecanum_drive_controller/process_usage.hpp"
+
+TEST(ProcessUsageTest, when_allocating_and_spawning_expect_usage_grows) {
+  const auto before = mecanum_drive_controller::sample_process_usage();
+  EXPECT_GE(before.threads, 1);
+
+  std::vector<char> buffer(1 << 20, 1);
+  std::atomic<bool> running{true};
+  std::thread thread([&]() {
+    while (running.load()) {
+      std::this_thread::yield();
+    }
+  });
+  const auto usage = mecanum_drive_controller::sample_process_usage() - before;
+  running = false;
+  thread.join();
+
+  EXPECT_GE(usage.heap_bytes, 1 << 20);
+  EXPECT_EQ(usage.threads, 1);
+}
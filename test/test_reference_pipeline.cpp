@@ -0,0 +1,68 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cmath>
+
+#include "mecanum_drive_controller/kinematics.hpp"
+#include "mecanum_drive_controller/reference_pipeline.hpp"
+
+TEST(ReferencePipelineTest, when_stages_configured_expect_applied_in_order) {
+  using mecanum_drive_controller::BodyTwist;
+  mecanum_drive_controller::ReferencePipeline pipeline;
+  mecanum_drive_controller::ReferencePipelineParams params;
+  params.scale = {0.5, 0.5, 0.5};
+  params.deadband = {0.1, 0.1, 0.1};
+  params.frame = {1.0, 0.0, M_PI / 2.0};
+
+  // an empty pipeline keeps the reference
+  BodyTwist twist{0.15, -0.15, 1.0};
+  pipeline.process(twist);
+  EXPECT_EQ(twist.linear_x, 0.15);
+  EXPECT_EQ(twist.linear_y, -0.15);
+  EXPECT_EQ(twist.angular_z, 1.0);
+
+  // the order matters: scaled below the deadband or kept
+  ASSERT_TRUE(pipeline.configure({"scale", "deadband"}, params));
+  twist = {0.15, -0.15, 1.0};
+  pipeline.process(twist);
+  EXPECT_EQ(twist.linear_x, 0.0);
+  EXPECT_EQ(twist.linear_y, 0.0);
+  EXPECT_EQ(twist.angular_z, 0.5);
+  ASSERT_TRUE(pipeline.configure({"deadband", "scale"}, params));
+  twist = {0.15, -0.15, 1.0};
+  pipeline.process(twist);
+  EXPECT_NEAR(twist.linear_x, 0.075, 1e-12);
+  EXPECT_NEAR(twist.linear_y, -0.075, 1e-12);
+
+  // a frame 1 m ahead, turned left: its x is the base's y, its rotation
+  // moves the base sideways
+  ASSERT_TRUE(pipeline.configure({"frame"}, params));
+  ASSERT_EQ(pipeline.size(), 1u);
+  EXPECT_EQ(pipeline.stage(0), mecanum_drive_controller::ReferenceStage::FRAME);
+  twist = {1.0, 0.0, 1.0};
+  pipeline.process(twist);
+  EXPECT_NEAR(twist.linear_x, 0.0, 1e-12);
+  EXPECT_NEAR(twist.linear_y, 0.0, 1e-12);
+  EXPECT_EQ(twist.angular_z, 1.0);
+
+  // unknown and repeated stages leave an empty pipeline
+  EXPECT_FALSE(pipeline.configure({"scale", "smooth"}, params));
+  EXPECT_EQ(pipeline.error(), "unknown stage 'smooth'");
+  EXPECT_EQ(pipeline.size(), 0u);
+  EXPECT_FALSE(pipeline.configure({"limit", "scale", "limit"}, params));
+  EXPECT_EQ(pipeline.error(), "repeated stage 'limit'");
+  EXPECT_EQ(pipeline.size(), 0u);
+}
@@ -0,0 +1,135 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mecanum_drive_controller/reference_socket_listener.hpp"
+
+TEST(ReferenceSocketListenerTest, when_frame_corrupted_expect_rejected) {
+  mecanum_drive_controller::ReferenceFrame frame;
+  frame.sequence = 42;
+  frame.stamp_nanoseconds = 1234567890123;
+  frame.linear_x = 1.5;
+  frame.linear_y = -0.5;
+  frame.angular_z = 0.25;
+  std::array<std::uint8_t, mecanum_drive_controller::REFERENCE_FRAME_SIZE>
+      buffer;
+  mecanum_drive_controller::encode_reference_frame(frame, buffer);
+
+  mecanum_drive_controller::ReferenceFrame decoded;
+  ASSERT_TRUE(mecanum_drive_controller::decode_reference_frame(
+      buffer.data(), buffer.size(), decoded));
+  EXPECT_EQ(decoded.sequence, 42u);
+  EXPECT_EQ(decoded.stamp_nanoseconds, 1234567890123);
+  EXPECT_EQ(decoded.linear_x, 1.5);
+  EXPECT_EQ(decoded.linear_y, -0.5);
+  EXPECT_EQ(decoded.angular_z, 0.25);
+
+  EXPECT_FALSE(mecanum_drive_controller::decode_reference_frame(
+      buffer.data(), buffer.size() - 1, decoded));
+  buffer[20] ^= 0x01;
+  EXPECT_FALSE(mecanum_drive_controller::decode_reference_frame(
+      buffer.data(), buffer.size(), decoded));
+}
+
+TEST(ReferenceSocketListenerTest,
+     when_frames_sent_over_unix_socket_expect_newer_ones_accepted) {
+  using mecanum_drive_controller::ReferenceFrame;
+  using mecanum_drive_controller::ReferenceSocketListener;
+  const std::string path = "/tmp/test_mecanum_drive_controller_" +
+                           std::to_string(::getpid()) + ".sock";
+
+  std::mutex mutex;
+  std::vector<ReferenceFrame> received;
+  ReferenceSocketListener listener;
+  ASSERT_TRUE(listener.start(ReferenceSocketListener::Type::UNIX, path, 0,
+                             [&](const ReferenceFrame &frame) {
+                               std::lock_guard<std::mutex> lock(mutex);
+                               received.push_back(frame);
+                             }))
+      << listener.error();
+
+  const int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+  ASSERT_GE(fd, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+  auto send_frame = [&](const std::uint32_t sequence, const double linear_x) {
+    ReferenceFrame frame;
+    frame.sequence = sequence;
+    frame.linear_x = linear_x;
+    std::array<std::uint8_t, mecanum_drive_controller::REFERENCE_FRAME_SIZE>
+        buffer;
+    mecanum_drive_controller::encode_reference_frame(frame, buffer);
+    ASSERT_EQ(::sendto(fd, buffer.data(), buffer.size(), 0,
+                       reinterpret_cast<const sockaddr *>(&address),
+                       sizeof(address)),
+              static_cast<ssize_t>(buffer.size()));
+  };
+  send_frame(5, 1.0);
+  send_frame(4, 2.0); // out of order
+  send_frame(6, 3.0);
+
+  const auto until =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+  while (listener.accepted_count() + listener.rejected_count() < 3 &&
+         std::chrono::steady_clock::now() < until) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  listener.stop();
+  ::close(fd);
+
+  ASSERT_EQ(received.size(), 2u);
+  EXPECT_EQ(received[0].linear_x, 1.0);
+  EXPECT_EQ(received[1].linear_x, 3.0);
+  EXPECT_EQ(listener.rejected_count(), 1u);
+}
+
+TEST(ReferenceSocketListenerTest,
+     when_unix_path_is_no_socket_expect_start_failed_and_file_kept) {
+  using mecanum_drive_controller::ReferenceFrame;
+  using mecanum_drive_controller::ReferenceSocketListener;
+  const std::string path = "/tmp/test_mecanum_drive_controller_" +
+                           std::to_string(::getpid()) + ".txt";
+  {
+    std::ofstream file(path);
+    file << "keep";
+  }
+
+  ReferenceSocketListener listener;
+  EXPECT_FALSE(listener.start(ReferenceSocketListener::Type::UNIX, path, 0,
+                              [](const ReferenceFrame &) {}));
+  EXPECT_NE(listener.error().find("not a socket"), std::string::npos);
+
+  std::ifstream file(path);
+  std::string content;
+  file >> content;
+  EXPECT_EQ(content, "keep");
+  ::unlink(path.c_str());
+}
@@ -0,0 +1,53 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <thread>
+
+#include "mecanum_drive_controller/seqlock.hpp"
+
+// readers running concurrently with the writer must never see a mix of two
+// published values
+TEST(SeqLockTest, when_read_concurrently_expect_no_torn_values) {
+  struct Payload {
+    double a;
+    double b;
+    double c;
+  };
+  mecanum_drive_controller::SeqLock<Payload> seqlock;
+  seqlock.store({0.0, 0.0, 0.0});
+
+  std::atomic<bool> done{false};
+  std::thread writer([&]() {
+    for (int i = 1; i <= 200000; ++i) {
+      seqlock.store({1.0 * i, -1.0 * i, 2.0 * i});
+    }
+    done = true;
+  });
+
+  size_t reads = 0;
+  while (!done) {
+    const auto value = seqlock.load();
+    ASSERT_EQ(value.b, -value.a);
+    ASSERT_EQ(value.c, 2.0 * value.a);
+    ++reads;
+  }
+  writer.join();
+
+  EXPECT_GT(reads, 0u);
+  EXPECT_EQ(seqlock.load().a, 200000.0);
+  EXPECT_EQ(seqlock.version(), 200001u);
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "mecanum_drive_controller/shared_realtime_publisher.hpp"
+
+namespace {
+struct CountingPublisher {
+  void publish(const int &msg) {
+    last.store(msg);
+    count.fetch_add(1);
+  }
+  std::atomic<int> last{0};
+  std::atomic<int> count{0};
+};
+
+using TestPublisher =
+    mecanum_drive_controller::SharedRealtimePublisher<int, CountingPublisher>;
+
+// waits for the shared thread to publish `count` messages in total
+bool wait_for_count(const CountingPublisher &publisher, const int count) {
+  for (int i = 0; i < 1000 && publisher.count.load() < count; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return publisher.count.load() == count;
+}
+} // namespace
+
+// publishers of several instances share one thread, a pending message blocks
+// the next one until it is published
+TEST(SharedRealtimePublisherTest, when_unlocked_and_published_expect_sent) {
+  auto first = std::make_shared<CountingPublisher>();
+  auto second = std::make_shared<CountingPublisher>();
+  TestPublisher first_publisher(first);
+  TestPublisher second_publisher(second);
+  EXPECT_EQ(mecanum_drive_controller::SharedPublisherThread::acquire().get(),
+            mecanum_drive_controller::SharedPublisherThread::acquire().get());
+
+  ASSERT_TRUE(first_publisher.trylock());
+  first_publisher.msg_ = 1;
+  first_publisher.unlockAndPublish();
+  ASSERT_TRUE(second_publisher.trylock());
+  second_publisher.msg_ = 2;
+  second_publisher.unlockAndPublish();
+  ASSERT_TRUE(wait_for_count(*first, 1));
+  ASSERT_TRUE(wait_for_count(*second, 1));
+  EXPECT_EQ(first->last.load(), 1);
+  EXPECT_EQ(second->last.load(), 2);
+
+  // an unlocked message is not published
+  ASSERT_TRUE(first_publisher.trylock());
+  first_publisher.msg_ = 3;
+  EXPECT_FALSE(first_publisher.trylock());
+  first_publisher.unlock();
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_EQ(first->count.load(), 1);
+
+  // a locked slot is waited for
+  first_publisher.lock();
+  first_publisher.msg_ = 4;
+  first_publisher.unlockAndPublish();
+  ASSERT_TRUE(wait_for_count(*first, 2));
+  EXPECT_EQ(first->last.load(), 4);
+}
+
+// a removed publisher is not accessed anymore, the thread stops with its
+// last user
+TEST(SharedRealtimePublisherTest, when_destroyed_expect_not_published) {
+  auto counting = std::make_shared<CountingPublisher>();
+  std::weak_ptr<mecanum_drive_controller::SharedPublisherThread> thread;
+  {
+    TestPublisher publisher(counting);
+    thread = mecanum_drive_controller::SharedPublisherThread::acquire();
+    ASSERT_TRUE(publisher.trylock());
+    publisher.msg_ = 1;
+    publisher.unlockAndPublish();
+  }
+  EXPECT_TRUE(thread.expired());
+  EXPECT_LE(counting->count.load(), 1);
+}
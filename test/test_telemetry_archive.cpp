@@ -0,0 +1,256 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "mecanum_drive_controller/spsc_queue.hpp"
+#include "mecanum_drive_controller/telemetry_archive.hpp"
+#include "mecanum_drive_controller/telemetry_recorder.hpp"
+
+using mecanum_drive_controller::NR_TELEMETRY_CHANNELS;
+using mecanum_drive_controller::TelemetryArchiveReader;
+using mecanum_drive_controller::TelemetryArchiveWriter;
+using mecanum_drive_controller::TelemetrySample;
+
+class TelemetryArchiveTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path_ = "/tmp/test_telemetry_archive_" + std::to_string(::getpid()) +
+            "_" +
+            ::testing::UnitTest::GetInstance()->current_test_info()->name() +
+            ".mdta";
+  }
+
+  void TearDown() override { std::remove(path_.c_str()); }
+
+  // 1 kHz samples of a robot driving a circle
+  static TelemetrySample make_sample(const std::size_t n) {
+    TelemetrySample sample;
+    const double t = 1e-3 * static_cast<double>(n);
+    // small jitter, as real control loops have
+    sample.stamp_nanoseconds = 1700000000000000000 +
+                               static_cast<std::int64_t>(n) * 1000000 +
+                               static_cast<std::int64_t>(n % 7) * 1000;
+    for (std::size_t i = 0; i < NR_TELEMETRY_CHANNELS; ++i) {
+      sample.values[i] = std::sin(t + static_cast<double>(i)) *
+                         (1.0 + static_cast<double>(i));
+    }
+    return sample;
+  }
+
+  void write_samples(const std::size_t count, const std::size_t block_samples,
+                     const bool close = true) {
+    TelemetryArchiveWriter writer;
+    ASSERT_TRUE(writer.open(
+        path_, mecanum_drive_controller::default_telemetry_quantization(),
+        block_samples));
+    for (std::size_t n = 0; n < count; ++n) {
+      ASSERT_TRUE(writer.append(make_sample(n)));
+    }
+    if (close) {
+      ASSERT_TRUE(writer.close());
+    } else {
+      // imitate a crash: blocks are on disk, the index is not
+      ASSERT_TRUE(writer.flush());
+      std::ifstream file(path_, std::ios::binary);
+      truncated_.assign(std::istreambuf_iterator<char>(file), {});
+    }
+  }
+
+  std::string path_;
+  std::vector<char> truncated_;
+};
+
+TEST_F(TelemetryArchiveTest, when_range_read_expect_quantized_samples) {
+  write_samples(10000, 1000);
+
+  TelemetryArchiveReader reader;
+  ASSERT_TRUE(reader.open(path_)) << reader.error();
+  EXPECT_TRUE(reader.has_index());
+  ASSERT_EQ(reader.blocks().size(), 10u);
+
+  const auto quantization = reader.quantization();
+  const auto begin = make_sample(2500).stamp_nanoseconds;
+  const auto end = make_sample(2999).stamp_nanoseconds;
+  std::vector<TelemetrySample> samples;
+  ASSERT_TRUE(reader.read(begin, end, [&](const TelemetrySample &sample) {
+    samples.push_back(sample);
+  }));
+
+  ASSERT_EQ(samples.size(), 500u);
+  for (std::size_t n = 0; n < samples.size(); ++n) {
+    const auto expected = make_sample(2500 + n);
+    ASSERT_EQ(samples[n].stamp_nanoseconds, expected.stamp_nanoseconds);
+    for (std::size_t i = 0; i < NR_TELEMETRY_CHANNELS; ++i) {
+      ASSERT_NEAR(samples[n].values[i], expected.values[i],
+                  0.5 * quantization[i] + 1e-12);
+    }
+  }
+
+  // much smaller than 8 bytes per value
+  std::ifstream file(path_, std::ios::binary | std::ios::ate);
+  EXPECT_LT(static_cast<std::size_t>(file.tellg()),
+            10000u * (NR_TELEMETRY_CHANNELS + 1) * 8 / 3);
+}
+
+TEST_F(TelemetryArchiveTest, when_non_finite_values_written_expect_nan) {
+  TelemetryArchiveWriter writer;
+  ASSERT_TRUE(writer.open(
+      path_, mecanum_drive_controller::default_telemetry_quantization(), 10));
+  auto sample = make_sample(0);
+  sample.values[2] = std::numeric_limits<double>::quiet_NaN();
+  sample.values[3] = std::numeric_limits<double>::infinity();
+  ASSERT_TRUE(writer.append(sample));
+  ASSERT_TRUE(writer.append(make_sample(1)));
+  ASSERT_TRUE(writer.close());
+
+  TelemetryArchiveReader reader;
+  ASSERT_TRUE(reader.open(path_));
+  std::vector<TelemetrySample> samples;
+  reader.read(std::numeric_limits<std::int64_t>::min(),
+              std::numeric_limits<std::int64_t>::max(),
+              [&](const TelemetrySample &s) { samples.push_back(s); });
+  ASSERT_EQ(samples.size(), 2u);
+  EXPECT_TRUE(std::isnan(samples[0].values[2]));
+  EXPECT_TRUE(std::isnan(samples[0].values[3]));
+  EXPECT_NEAR(samples[1].values[2], make_sample(1).values[2], 1e-4);
+}
+
+TEST_F(TelemetryArchiveTest, when_index_missing_expect_blocks_scanned) {
+  write_samples(2500, 1000, false);
+  // drop the index and cut the last block in half, as after a crash
+  std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+  file.write(truncated_.data(),
+             static_cast<std::streamsize>(truncated_.size() - 100));
+  file.close();
+
+  TelemetryArchiveReader reader;
+  ASSERT_TRUE(reader.open(path_));
+  EXPECT_FALSE(reader.has_index());
+  ASSERT_EQ(reader.blocks().size(), 2u);
+
+  std::size_t count = 0;
+  ASSERT_TRUE(reader.read(std::numeric_limits<std::int64_t>::min(),
+                          std::numeric_limits<std::int64_t>::max(),
+                          [&](const TelemetrySample &) { ++count; }));
+  EXPECT_EQ(count, 2000u);
+}
+
+TEST_F(TelemetryArchiveTest, when_block_corrupted_expect_block_skipped) {
+  write_samples(3000, 1000);
+  TelemetryArchiveReader reader;
+  ASSERT_TRUE(reader.open(path_));
+  const auto offset = reader.blocks()[1].offset;
+
+  // flip a payload byte of the second block
+  std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekg(static_cast<std::streamoff>(offset + 100));
+  char byte;
+  file.get(byte);
+  file.seekp(static_cast<std::streamoff>(offset + 100));
+  file.put(static_cast<char>(byte ^ 0x10));
+  file.close();
+
+  ASSERT_TRUE(reader.open(path_));
+  std::size_t count = 0;
+  ASSERT_TRUE(reader.read(std::numeric_limits<std::int64_t>::min(),
+                          std::numeric_limits<std::int64_t>::max(),
+                          [&](const TelemetrySample &) { ++count; }));
+  EXPECT_EQ(count, 2000u);
+  EXPECT_EQ(reader.corrupted_block_count(), 1u);
+}
+
+TEST_F(TelemetryArchiveTest,
+       when_index_missing_and_block_header_corrupted_expect_resynchronized) {
+  write_samples(4000, 1000, false);
+  // drop the index, as after a crash
+  std::ofstream truncated(path_, std::ios::binary | std::ios::trunc);
+  truncated.write(truncated_.data(),
+                  static_cast<std::streamsize>(truncated_.size()));
+  truncated.close();
+
+  TelemetryArchiveReader reader;
+  ASSERT_TRUE(reader.open(path_));
+  ASSERT_EQ(reader.blocks().size(), 4u);
+  const auto second = reader.blocks()[1].offset;
+  const auto third = reader.blocks()[2].offset;
+
+  // break the magic of the second block and shrink the payload size of the
+  // third one, so it still fits into the file but misaligns the scan
+  std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(static_cast<std::streamoff>(second));
+  file.put('X');
+  file.seekp(static_cast<std::streamoff>(third + 24));
+  file.put(static_cast<char>(0x10));
+  file.close();
+
+  ASSERT_TRUE(reader.open(path_));
+  EXPECT_FALSE(reader.has_index());
+  ASSERT_EQ(reader.blocks().size(), 2u);
+  EXPECT_EQ(reader.blocks()[1].first_stamp_nanoseconds,
+            make_sample(3000).stamp_nanoseconds);
+  std::size_t count = 0;
+  ASSERT_TRUE(reader.read(std::numeric_limits<std::int64_t>::min(),
+                          std::numeric_limits<std::int64_t>::max(),
+                          [&](const TelemetrySample &) { ++count; }));
+  EXPECT_EQ(count, 2000u);
+  EXPECT_EQ(reader.corrupted_block_count(), 2u);
+}
+
+TEST_F(TelemetryArchiveTest, when_recorder_stopped_expect_all_samples_written) {
+  mecanum_drive_controller::TelemetryRecorder recorder;
+  ASSERT_TRUE(recorder.start(path_, 4096, 100));
+  for (std::size_t n = 0; n < 1234; ++n) {
+    ASSERT_TRUE(recorder.record(make_sample(n)));
+  }
+  recorder.stop();
+  EXPECT_EQ(recorder.dropped_count(), 0u);
+
+  TelemetryArchiveReader reader;
+  ASSERT_TRUE(reader.open(path_));
+  EXPECT_TRUE(reader.has_index());
+  std::size_t count = 0;
+  ASSERT_TRUE(reader.read(std::numeric_limits<std::int64_t>::min(),
+                          std::numeric_limits<std::int64_t>::max(),
+                          [&](const TelemetrySample &) { ++count; }));
+  EXPECT_EQ(count, 1234u);
+}
+
+TEST(SpscQueueTest, when_full_expect_push_rejected_and_order_kept) {
+  mecanum_drive_controller::SpscQueue<int> queue(3);
+  EXPECT_EQ(queue.capacity(), 3u);
+  int value = 0;
+  EXPECT_FALSE(queue.pop(value));
+
+  for (int round = 0; round < 5; ++round) {
+    EXPECT_TRUE(queue.push(3 * round));
+    EXPECT_TRUE(queue.push(3 * round + 1));
+    EXPECT_TRUE(queue.push(3 * round + 2));
+    EXPECT_FALSE(queue.push(-1));
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_TRUE(queue.pop(value));
+      EXPECT_EQ(value, 3 * round + i);
+    }
+    EXPECT_FALSE(queue.pop(value));
+  }
+}
@@ -0,0 +1,49 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cmath>
+#include <limits>
+
+#include "mecanum_drive_controller/wheel_velocity_estimator.hpp"
+
+TEST(WheelVelocityEstimatorTest, when_speed_changes_expect_window_adapted) {
+  mecanum_drive_controller::WheelVelocityEstimator estimator;
+  const double tick = 2.0 * M_PI / 1024.0;
+  estimator.configure(1, 50, 3.0 * tick);
+
+  // creep speed, less than a tick per cycle
+  double position = 0.0;
+  double velocity = 0.0;
+  for (size_t n = 0; n < 1000; ++n) {
+    position += 0.5 * 0.001;
+    velocity = estimator.update(0, std::floor(position / tick) * tick, 0.001);
+  }
+  EXPECT_NEAR(velocity, 0.5, 0.2);
+  EXPECT_GT(estimator.window(0), 20u);
+
+  // several ticks per cycle
+  for (size_t n = 0; n < 100; ++n) {
+    position += 50.0 * 0.001;
+    velocity = estimator.update(0, std::floor(position / tick) * tick, 0.001);
+  }
+  EXPECT_NEAR(velocity, 50.0, tick / 0.001);
+  EXPECT_EQ(estimator.window(0), 1u);
+
+  // invalid positions invalidate the estimate and drop the history
+  EXPECT_TRUE(std::isnan(estimator.update(
+      0, std::numeric_limits<double>::quiet_NaN(), 0.001)));
+  EXPECT_EQ(estimator.update(0, position, 0.001), 0.0);
+}
@@ -0,0 +1,37 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cmath>
+#include <limits>
+
+#include "mecanum_drive_controller/window_statistics.hpp"
+
+TEST(WindowStatisticsTest, when_values_nan_expect_them_ignored) {
+  mecanum_drive_controller::WindowStatistics<2> statistics;
+  EXPECT_TRUE(std::isnan(statistics.mean(0)));
+  statistics.add({1.0, std::numeric_limits<double>::quiet_NaN()});
+  statistics.add({-2.0, std::numeric_limits<double>::quiet_NaN()});
+  statistics.add({4.0, std::numeric_limits<double>::quiet_NaN()});
+  EXPECT_EQ(statistics.min(0), -2.0);
+  EXPECT_EQ(statistics.max(0), 4.0);
+  EXPECT_EQ(statistics.mean(0), 1.0);
+  EXPECT_EQ(statistics.count(0), 3u);
+  EXPECT_TRUE(std::isnan(statistics.min(1)));
+  EXPECT_TRUE(std::isnan(statistics.max(1)));
+  EXPECT_EQ(statistics.count(1), 0u);
+  statistics.reset();
+  EXPECT_EQ(statistics.count(0), 0u);
+}
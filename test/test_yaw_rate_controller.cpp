@@ -0,0 +1,48 @@
+// Copyright (c) 2023, Stogl Robotics Consulting UG (haftungsbeschränkt)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "mecanum_drive_controller/yaw_rate_controller.hpp"
+
+TEST(YawRateControllerTest, when_rotation_under_realized_expect_converged) {
+  mecanum_drive_controller::YawRateController controller;
+  // unconfigured, the command passes unchanged
+  EXPECT_EQ(controller.update(1.0, 0.0, 0.01), 1.0);
+
+  // the base realizes 80 % of the commanded yaw rate
+  controller.configure(0.5, 2.0, 0.3);
+  double measured = 0.0;
+  double max_correction = 0.0;
+  for (size_t n = 0; n < 1000; ++n) {
+    const double command = controller.update(1.0, measured, 0.01);
+    max_correction = std::max(max_correction, controller.correction());
+    measured = 0.8 * command;
+  }
+  EXPECT_NEAR(measured, 1.0, 1e-4);
+  EXPECT_NEAR(controller.correction(), 0.25, 1e-4);
+  EXPECT_LE(max_correction, 0.3);
+
+  // a missing measurement applies no correction and keeps the integral
+  EXPECT_EQ(controller.update(1.0, std::numeric_limits<double>::quiet_NaN(),
+                              0.01),
+            1.0);
+  EXPECT_NEAR(controller.update(1.0, 1.0, 0.01), 1.25, 1e-4);
+
+  controller.reset();
+  EXPECT_EQ(controller.update(1.0, 1.0, 0.01), 1.0);
+}